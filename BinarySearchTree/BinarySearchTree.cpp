@@ -6,10 +6,17 @@
 // Description : Bid handling system, BST style
 //============================================================================
 
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <time.h>
+#include <vector>
 
+#include "Bid.hpp"
+#include "BidSnapshot.hpp"
+#include "BloomFilter.hpp"
 #include "CSVparser.hpp"
+#include "NodePool.hpp"
 
 using namespace std;
 //using std::unique_ptr;
@@ -18,30 +25,18 @@ using namespace std;
 // Global definitions visible to all methods and classes
 //============================================================================
 
-// forward declarations
-double strToDouble(string str, char ch);
-
-// define a structure to hold bid information
-struct Bid {
-	string bidId; // unique identifier
-	string title;
-	string fund;
-	double amount;
-	Bid() {
-		amount = 0.0;
-	}
-};
-
 // Internal structure for tree node
 struct Node {
 	Bid bid;
 	Node *left;
 	Node *right;
+	int height; // nodes on the longest path down from here, a leaf is 1
 
 	// default constructor
 	Node() {
 		left = nullptr;
 		right = nullptr;
+		height = 1;
 	}
 
 	// initialize with a bid
@@ -51,6 +46,13 @@ struct Node {
 	}
 };
 
+/**
+ * Three-way compare of two bid ids, same sign convention as string::compare
+ */
+int compareIds(uint32_t a, uint32_t b) {
+	return (a > b) - (a < b);
+}
+
 //============================================================================
 // Binary Search Tree class definition
 //============================================================================
@@ -63,63 +65,58 @@ class BinarySearchTree {
 
 private:
 	Node* root;
+	bool balanced; // AVL rotations keep the height near log n whatever the insert order
+	BloomFilter filter; // misses are usually answered here without walking down the tree
+	double filterRate = DEFAULT_FALSE_POSITIVE_RATE; // 0 turns the filter off
+	vector<Node**> path; // links passed on the way down, kept on the heap so any depth fits
+	NodePool<Node> pool; // every node in the tree
 
-	void addNode(Node* node, Bid bid);
+	void addNode(Bid bid);
 	void InOrderHelper(Node* node);
 	void PreOrderHelper(Node* node);
 	void PostOrderHelper(Node* node);
-	Node* removeNode(Node* node, string bidId);
+	void removeNode(uint32_t bidId);
+	void retrace();
+	void rebuildFilter(size_t expected);
+	static int height(Node* node);
+	static void updateHeight(Node* node);
+	static Node* rotateLeft(Node* node);
+	static Node* rotateRight(Node* node);
+	Node* rebalance(Node* node);
 
 public:
-	BinarySearchTree();
+	BinarySearchTree(bool balanced = true);
 	virtual ~BinarySearchTree();
-	void BSTDestructorHelper(Node* node);
 	void InOrder();
 	void PostOrder();
 	void PreOrder();
 	void Insert(Bid bid);
-	void Remove(string bidId);
-	Bid Search(string bidId);
+	void Remove(uint32_t bidId);
+	void Remove(string_view bidId);
+	const Bid* Search(uint32_t bidId);
+	const Bid* Search(string_view bidId);
 	Node* ParentSearch(Node* child); // Created but unused
+	void SetFilterRate(double falsePositiveRate);
+	const BloomFilter& Filter();
+	int Height();
 };
 
 /**
  * Default constructor
+ *
+ * @param balanced false keeps the plain tree, whose shape follows the insert order
  */
-BinarySearchTree::BinarySearchTree() {
+BinarySearchTree::BinarySearchTree(bool balanced) {
 	root = nullptr;
+	this->balanced = balanced;
 	return;
 }
 
 /**
  * Destructor.
- * Iterates through the BST and frees related Node memory with a helper function. (recursive)
+ * The pool gives back every node in one go, without walking the tree.
  */
 BinarySearchTree::~BinarySearchTree() {
-	BSTDestructorHelper(root); // Recursive function helper
-	root = nullptr; // Called when all Node are deleted
-	return;
-}
-
-/**
- * Helper function.
- * Deletes the current Binary Search Tree node by node. (recursive)
- *
- * @param Root node in tree
- */
-void BinarySearchTree::BSTDestructorHelper(Node* node) {
-	// FIXME: Create unit tests to check destructor behavior
-	if (node == nullptr) { // Stop us from traversing nothing
-		return;
-	}
-
-	BSTDestructorHelper(node->left); // Recursively call left until we cannot go left anymore
-	BSTDestructorHelper(node->right); // Recursively call right until we canot go right anymore
-	string bidId = node->bid.bidId; // Take the node's bidId,
-	Remove(bidId); // feed it to remove,
-	delete node; // then delete the node.
-	node = nullptr;
-	return;
 }
 
 /**
@@ -147,81 +144,153 @@ void BinarySearchTree::PreOrder() {
  * Insert a bid
  */
 void BinarySearchTree::Insert(Bid bid) {
-	if (root == nullptr) {
-		root = new Node(bid);
+	this->addNode(bid);
+
+	if (filterRate > 0) {
+		if (filter.Size() >= filter.Capacity()) { // full or never built, size it for twice what is here now
+			rebuildFilter(pool.Size() * 2);
+		}
+		else {
+			filter.Add(bid.bidId);
+		}
+	}
+	return;
+}
+
+/**
+ * Size the Bloom filter and add every bid in the tree to it
+ *
+ * @param expected Number of bids it should hold at filterRate
+ */
+void BinarySearchTree::rebuildFilter(size_t expected) {
+	filter.Build(max<size_t>(expected, pool.Size()), filterRate); // never fewer than the tree holds
+	vector<Node*> pending; // explicit stack, a lopsided tree is too deep to recurse
+	if (root != nullptr) {
+		pending.push_back(root);
+	}
+	while (!pending.empty()) {
+		Node* node = pending.back();
+		pending.pop_back();
+		filter.Add(node->bid.bidId);
+		if (node->left != nullptr) {
+			pending.push_back(node->left);
+		}
+		if (node->right != nullptr) {
+			pending.push_back(node->right);
+		}
+	}
+}
+
+/**
+ * Set the false positive rate of the Bloom filter in front of Search,
+ * the filter is rebuilt for it. 0 turns the filter off.
+ *
+ * @param falsePositiveRate Chance a missing bid still walks the tree
+ */
+void BinarySearchTree::SetFilterRate(double falsePositiveRate) {
+	filterRate = falsePositiveRate;
+	if (filterRate > 0) {
+		rebuildFilter(pool.Size()); // the filter may be empty after Clear(), the tree knows its count
 	}
 	else {
-		this->addNode(root, bid);
+		filter.Clear();
 	}
-	return;
+}
+
+/**
+ * The Bloom filter, for its counters
+ */
+const BloomFilter& BinarySearchTree::Filter() {
+	return filter;
+}
+
+/**
+ * Nodes on the longest path from the root, 0 for an empty tree
+ */
+int BinarySearchTree::Height() {
+	return height(root);
 }
 
  /**
   * Remove a bid
   *
-  * @param string Bid to be removed
+  * @param uint32_t Bid to be removed
   */
-void BinarySearchTree::Remove(string bidId) {
-	this->removeNode(root, bidId);
-	cout << "Removed " + bidId << endl;
+void BinarySearchTree::Remove(uint32_t bidId) {
+	this->removeNode(bidId);
+	cout << "Removed " << bidId << endl;
 	return;
 }
 
-Node* BinarySearchTree::removeNode(Node* node, string bidId) { 
-	if (node == nullptr) {
-		return nullptr;
+/**
+ * Remove a bid by its Auction ID as text
+ */
+void BinarySearchTree::Remove(string_view bidId) {
+	uint32_t id;
+	if (ParseBidId(bidId, id)) {
+		Remove(id);
 	}
-	
-	int comparisonResult = node->bid.bidId.compare(bidId); // target bidId compared to searched bidId
+}
+
+/**
+ * Remove a bid's node. A node with two children takes the bid of the next
+ * node down in order instead, and that node is unlinked.
+ *
+ * @param bidId Bid to be removed, nothing happens if it is not in the tree
+ */
+void BinarySearchTree::removeNode(uint32_t bidId) {
 	const int matchFlag = 0; // Zero is a match, less is shorter/lower more is longer/higher
-	//Node* parent = ParentSearch(node);
+	path.clear();
+	Node** link = &root;
 
-	if (comparisonResult < matchFlag) { // target is larger
-		node->left = removeNode(node->left, bidId); // Recurse down and replace the removed node
+	while (*link != nullptr) {
+		int comparisonResult = compareIds((*link)->bid.bidId, bidId); // target bidId compared to searched bidId
+		if (comparisonResult == matchFlag) {
+			break;
+		}
+		path.push_back(link);
+		link = comparisonResult < matchFlag ? &(*link)->left : &(*link)->right; // target is larger, go left
 	}
-	else if (comparisonResult > matchFlag) { // searched is larger
-		node->right = removeNode(node->right, bidId);
+	if (*link == nullptr) { // not in the tree
+		return;
 	}
-	else {
-		if (node->left == nullptr && node->right == nullptr) { // leaf case
-			delete node;
-			node = nullptr; // Keep the pointer safe
-			return nullptr;
-		}
-		else if (node->left != nullptr && node->right == nullptr) { // Right is null case ("Case 4")
-			Node* temp = node;
-			node = node->left;
-			delete temp;
-		}
-		else if (node->left == nullptr && node->right != nullptr) { // Left is null case ("Case 3")
-			Node* temp = node;
-			node = node->right;
-		}
-		else { // Two children case ("Case 1")
-			Node* temp = node->right;
-			while (temp->left != nullptr) {  // Traverse left
-				temp = temp->left;
-			}
-			node->bid = temp->bid;
-			node->right = removeNode(node->right, temp->bid.bidId); // Recursively remove successor since it was copied
+
+	Node* node = *link;
+	if (node->left != nullptr && node->right != nullptr) { // Two children case ("Case 1")
+		path.push_back(link);
+		Node** successor = &node->right;
+		while ((*successor)->left != nullptr) { // Traverse left
+			path.push_back(successor);
+			successor = &(*successor)->left;
 		}
+		node->bid = (*successor)->bid; // The successor is copied up and removed in its place
+		link = successor;
+		node = *successor;
 	}
-	return node;
+
+	*link = node->left != nullptr ? node->left : node->right; // At most one child left, it takes the node's place
+	pool.Release(node);
+	retrace();
 }
 
 /**
  * Search for a bid
  * 
- * @param string bidId to be searched for
+ * @param uint32_t bidId to be searched for
+ * @return The bid in its node, valid until the tree is next changed, or nullptr
  */
-Bid BinarySearchTree::Search(string bidId) {
+const Bid* BinarySearchTree::Search(uint32_t bidId) {
+	if (!filter.MayContain(bidId)) { // definitely not in the tree
+		return nullptr;
+	}
+
 	Node* currNode = root;
 	const int matchFlag = 0; // Zero is a match, less is shorter/lower more is longer/higher
 
 	while (currNode != nullptr) {
-		int comparisonResult = currNode->bid.bidId.compare(bidId); // Compare the search bidId against the currently held bidId
+		int comparisonResult = compareIds(currNode->bid.bidId, bidId); // Compare the search bidId against the currently held bidId
 		if (comparisonResult == matchFlag) { // Found the bid
-			return currNode->bid; // Return the currently held bid that matched
+			return &(currNode->bid); // Point at the currently held bid that matched
 		}
 		else if (comparisonResult < matchFlag) { // The check is less than what was checked against
 			currNode = currNode->left; // Shift loop left
@@ -231,8 +300,21 @@ Bid BinarySearchTree::Search(string bidId) {
 		} // Continue looping
 	} // Current is nullptr, match is not found
 
-	Bid bid;
-	return bid;
+	if (filter.Enabled()) {
+		filter.RecordFalsePositive();
+	}
+	return nullptr;
+}
+
+/**
+ * Search for a bid by its Auction ID as text, the text is parsed in place
+ */
+const Bid* BinarySearchTree::Search(string_view bidId) {
+	uint32_t id;
+	if (!ParseBidId(bidId, id)) { // not an Auction ID
+		return nullptr;
+	}
+	return Search(id);
 }
 
 /**
@@ -247,7 +329,7 @@ Node* BinarySearchTree::ParentSearch(Node* child) {
 	const int matchFlag = 0;
 
 	while (currNode != nullptr) {
-		int comparisonResult = currNode->bid.bidId.compare(parentNode->bid.bidId); // Compare the search bidId against the currently held parent bidId
+		int comparisonResult = compareIds(currNode->bid.bidId, parentNode->bid.bidId); // Compare the search bidId against the currently held parent bidId
 		if (currNode == child) { // Found the child
 			return parentNode; // Return the currently held parent that points to the child
 		}
@@ -265,45 +347,145 @@ Node* BinarySearchTree::ParentSearch(Node* child) {
 }
 
 /**
- * Add a bid to some node (recursive)
+ * Add a bid as a new leaf
  *
- * @param node Current node in tree
  * @param bid Bid to be added
  */
-void BinarySearchTree::addNode(Node* node, Bid bid) {
-	
+void BinarySearchTree::addNode(Bid bid) {
 	const int matchFlag = 0; // Zero is a match
-	int comparisonResult = node->bid.bidId.compare(bid.bidId); // Compare the strings of the node and the input bid
-	
-	if (comparisonResult < matchFlag) { // Current node's bidID compared against bidID to be added
-		if (node->left == nullptr) { // Left subtree, if the string contained here is longer than or has a greater character value and left is null
-			node->left = new Node(bid); // Construct a new node and make it the left pointer of the current node
-		}
-		else { // Not null left
-			addNode(node->left, bid); // Recurse leftward
+	path.clear();
+	Node** link = &root;
+
+	while (*link != nullptr) {
+		path.push_back(link);
+		int comparisonResult = compareIds((*link)->bid.bidId, bid.bidId); // Compare the ids of the node and the input bid
+		link = comparisonResult < matchFlag ? &(*link)->left : &(*link)->right; // Left subtree for a larger id
+	}
+	*link = pool.Allocate(bid); // Construct a new node in the empty spot
+	retrace();
+}
+
+/**
+ * Walk back up the links addNode or removeNode came down, fixing heights
+ * and rebalancing. Once a subtree ends up as tall as it was before,
+ * nothing above it changed and the walk stops.
+ */
+void BinarySearchTree::retrace() {
+	while (!path.empty()) {
+		Node** link = path.back();
+		path.pop_back();
+		int before = (*link)->height;
+		*link = rebalance(*link); // a rotation puts a new node at the top of this subtree
+		if ((*link)->height == before) {
+			break;
 		}
 	}
-	else { // Right subtree
-		if (node->right == nullptr) { // Greater and right is null
-			node->right = new Node(bid); // Node to be inserted becomes the right
+	path.clear();
+}
+
+/**
+ * Height of a subtree, 0 for an empty one
+ */
+int BinarySearchTree::height(Node* node) {
+	return node == nullptr ? 0 : node->height;
+}
+
+/**
+ * Recompute a node's height from its children
+ */
+void BinarySearchTree::updateHeight(Node* node) {
+	node->height = 1 + max(height(node->left), height(node->right));
+}
+
+/**
+ * Lift the right child above the node
+ *
+ * @param node Subtree root with a right child
+ * @return The new subtree root
+ */
+Node* BinarySearchTree::rotateLeft(Node* node) {
+	Node* pivot = node->right;
+	node->right = pivot->left;
+	pivot->left = node;
+	updateHeight(node); // now below the pivot, so it goes first
+	updateHeight(pivot);
+	return pivot;
+}
+
+/**
+ * Lift the left child above the node
+ *
+ * @param node Subtree root with a left child
+ * @return The new subtree root
+ */
+Node* BinarySearchTree::rotateRight(Node* node) {
+	Node* pivot = node->left;
+	node->left = pivot->right;
+	pivot->right = node;
+	updateHeight(node);
+	updateHeight(pivot);
+	return pivot;
+}
+
+/**
+ * Fix a node's height after one of its subtrees changed. In balanced mode
+ * a subtree two taller than its sibling is rotated back, once or twice.
+ *
+ * @param node Subtree root whose children are already balanced
+ * @return The node now at the top of this subtree
+ */
+Node* BinarySearchTree::rebalance(Node* node) {
+	updateHeight(node);
+	if (!balanced) {
+		return node;
+	}
+
+	int balance = height(node->left) - height(node->right);
+	if (balance > 1) { // left heavy
+		if (height(node->left->left) < height(node->left->right)) { // left-right, straighten it first
+			node->left = rotateLeft(node->left);
 		}
-		else { // Not null right
-			addNode(node->right, bid); // Recurse rightward
+		return rotateRight(node);
+	}
+	if (balance < -1) { // right heavy
+		if (height(node->right->right) < height(node->right->left)) { // right-left
+			node->right = rotateRight(node->right);
 		}
+		return rotateLeft(node);
 	}
+	return node;
 }
 
 /**
- * InOrderHelper
+ * InOrderHelper, Morris style: before going down a node's right subtree,
+ * the last node printed in it gets a temporary left link back up, so the
+ * walk needs no stack. Every thread is taken out again on the way back.
  *
  * @param node Current node in tree
  */
 void BinarySearchTree::InOrderHelper(Node* node) {
-	if (node != nullptr) {
-		InOrderHelper(node->right); // Recurse leftward to print all items before
-		cout << node->bid.bidId << ": " << node->bid.title << " | " << node->bid.amount << " | "
-			<< node->bid.fund << endl;
-		InOrderHelper(node->left); // Now recurse rightward now that we have printed all nodes to the left and the input node
+	while (node != nullptr) {
+		if (node->right == nullptr) { // Nothing to print before this node
+			cout << node->bid.bidId << ": " << node->bid.Title() << " | " << node->bid.Dollars() << " | "
+				<< node->bid.Fund() << endl;
+			node = node->left; // A real child, or a thread back up
+			continue;
+		}
+
+		Node* last = node->right; // Printed just before this node, at the far left of the right subtree
+		while (last->left != nullptr && last->left != node) {
+			last = last->left;
+		}
+		if (last->left == nullptr) { // First visit, thread back and print the right subtree first
+			last->left = node;
+			node = node->right;
+		}
+		else { // Came back up the thread, the right subtree is done
+			last->left = nullptr;
+			cout << node->bid.bidId << ": " << node->bid.Title() << " | " << node->bid.Dollars() << " | "
+				<< node->bid.Fund() << endl;
+			node = node->left;
+		}
 	}
 }
 
@@ -343,9 +525,9 @@ void BinarySearchTree::PreOrderHelper(Node* node) {
  *
  * @param bid struct containing the bid info
  */
-void displayBid(Bid bid) {
-	cout << bid.bidId << ": " << bid.title << " | " << bid.amount << " | "
-			<< bid.fund << endl;
+void displayBid(const Bid& bid) {
+	cout << bid.bidId << ": " << bid.Title() << " | " << bid.Dollars() << " | "
+			<< bid.Fund() << endl;
 	return;
 }
 
@@ -356,10 +538,26 @@ void displayBid(Bid bid) {
  * @return a container holding all the bids read
  */
 void loadBids(string csvPath, BinarySearchTree* bst) {
+	// A fresh snapshot of this file skips the CSV parse entirely
+	BidSnapshot snapshot;
+	if (snapshot.Open(csvPath)) {
+		cout << "Loading snapshot " << BidSnapshot::PathFor(csvPath) << endl;
+		for (size_t i = 0; i < snapshot.Size(); ++i) {
+			Bid bid;
+			bid.bidId = snapshot.BidId(i);
+			bid.title = bidStrings.Add(snapshot.Title(i));
+			bid.fund = bidStrings.Intern(snapshot.Fund(i));
+			bid.amount = snapshot.Amount(i);
+			bst->Insert(bid);
+		}
+		return;
+	}
+
 	cout << "Loading CSV file " << csvPath << endl;
 
-	// initialize the CSV Parser using the given path
-	csv::Parser file = csv::Parser(csvPath);
+	// stream the CSV file using the given path, rows are parsed while the file is still being read.
+	// Only the columns a Bid uses are split out.
+	csv::Stream file(csvPath, BID_COLUMNS);
 
 	// read and display header row - optional
 	vector<string> header = file.getHeader();
@@ -368,21 +566,28 @@ void loadBids(string csvPath, BinarySearchTree* bst) {
 	}
 	cout << "" << endl;
 
+	BidSnapshotWriter writer; // remembers every bid for the next start
+
 	try {
 		// loop to read rows of a CSV file
-		for (unsigned int i = 0; i < file.rowCount(); i++) {
+		for (csv::Row& row : file) { // one row buffer is reused for every record
 
 			// Create a data structure and add to the collection of bids
 			Bid bid;
-			bid.bidId = file[i][1];
-			bid.title = file[i][0];
-			bid.fund = file[i][8];
-			bid.amount = strToDouble(file[i][4], '$');
+			if (!BidFromRow(row, bid)) {
+				continue;
+			}
 
 			//cout << "Item: " << bid.title << ", Fund: " << bid.fund << ", Amount: " << bid.amount << endl;
 
 			// push this bid to the end
 			bst->Insert(bid);
+			writer.Add(bid.bidId, bid.Title(), bid.Fund(), bid.amount);
+		}
+
+		// only a complete load is worth keeping
+		if (!writer.Write(csvPath)) {
+			cerr << "Could not write snapshot " << BidSnapshot::PathFor(csvPath) << endl;
 		}
 	} catch (csv::Error &e) {
 		std::cerr << e.what() << std::endl;
@@ -390,16 +595,55 @@ void loadBids(string csvPath, BinarySearchTree* bst) {
 }
 
 /**
- * Simple C function to convert a string to a double
- * after stripping out unwanted char
+ * Build a plain and a balanced tree from the same bids in ascending id
+ * order, the worst case for the plain tree, and compare their heights and
+ * lookup times. The filter is off so every lookup walks the tree.
  *
- * credit: http://stackoverflow.com/a/24875936
- *
- * @param ch The character to strip out
+ * @param csvPath the path to the CSV file to load
  */
-double strToDouble(string str, char ch) {
-	str.erase(remove(str.begin(), str.end(), ch), str.end());
-	return atof(str.c_str());
+void balanceBenchmark(string csvPath) {
+	StringPool::Mark before = bidStrings.Position(); // the benchmark's text goes again when it is done
+	vector<Bid> bids;
+	try {
+		csv::Stream file(csvPath, BID_COLUMNS);
+		for (csv::Row& row : file) {
+			Bid bid;
+			if (!BidFromRow(row, bid)) {
+				continue;
+			}
+			bids.push_back(bid);
+		}
+	} catch (csv::Error &e) {
+		std::cerr << e.what() << std::endl;
+		bidStrings.Rewind(before);
+		return;
+	}
+	sort(bids.begin(), bids.end(), [](const Bid& a, const Bid& b) { return a.bidId < b.bidId; });
+	cout << bids.size() << " bids inserted in ascending id order" << endl;
+
+	for (bool balanced : { false, true }) {
+		BinarySearchTree tree(balanced);
+		tree.SetFilterRate(0);
+
+		auto start = chrono::steady_clock::now();
+		for (const Bid& bid : bids) {
+			tree.Insert(bid);
+		}
+		chrono::duration<double> insertTime = chrono::steady_clock::now() - start;
+
+		size_t found = 0;
+		start = chrono::steady_clock::now();
+		for (const Bid& bid : bids) {
+			found += tree.Search(bid.bidId) != nullptr;
+		}
+		chrono::duration<double, nano> searchTime = chrono::steady_clock::now() - start;
+
+		cout << (balanced ? "  AVL:   " : "  plain: ") << "height " << tree.Height()
+			<< ", insert " << insertTime.count() << " seconds, "
+			<< (bids.empty() ? 0.0 : searchTime.count() / bids.size()) << " ns per lookup, "
+			<< found << " found" << endl;
+	}
+	bidStrings.Rewind(before);
 }
 
 /**
@@ -429,7 +673,6 @@ int main(int argc, char* argv[]) {
 	// Define a binary search tree to hold all bids
 	BinarySearchTree* bst;
 	bst = new BinarySearchTree();
-	Bid bid;
 
 	int choice = 0;
 	while (choice != 9) {
@@ -438,6 +681,8 @@ int main(int argc, char* argv[]) {
 		cout << "  2. Display All Bids" << endl;
 		cout << "  3. Find Bid" << endl;
 		cout << "  4. Remove Bid" << endl;
+		cout << "  5. Bloom Filter Stats" << endl;
+		cout << "  6. Balance Benchmark" << endl;
 		cout << "  9. Exit" << endl;
 		cout << "Enter choice: ";
 		cin >> choice;
@@ -449,6 +694,11 @@ int main(int argc, char* argv[]) {
 			// Initialize a timer variable before loading bids
 			ticks = clock();
 
+			// A reload replaces the tree, and the text of its bids with it
+			delete bst;
+			bidStrings.Reset();
+			bst = new BinarySearchTree();
+
 			// Complete the method call to load the bids
 			loadBids(csvPath, bst);
 
@@ -464,15 +714,15 @@ int main(int argc, char* argv[]) {
 			bst->InOrder();
 			break;
 
-		case 3:
+		case 3: {
 			ticks = clock();
 
-			bid = bst->Search(bidKey);
+			const Bid* found = bst->Search(bidKey);
 
 			ticks = clock() - ticks; // current clock ticks minus starting clock ticks
 
-			if (!bid.bidId.empty()) {
-				displayBid(bid);
+			if (found != nullptr) {
+				displayBid(*found);
 			} else {
 				cout << "Bid Id " << bidKey << " not found." << endl;
 			}
@@ -481,10 +731,19 @@ int main(int argc, char* argv[]) {
 			cout << "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
 
 			break;
+		}
 
 		case 4:
 			bst->Remove(bidKey);
 			break;
+
+		case 5:
+			bst->Filter().PrintStats();
+			break;
+
+		case 6:
+			balanceBenchmark(csvPath);
+			break;
 		}
 	}
 
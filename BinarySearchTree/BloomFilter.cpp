@@ -0,0 +1,157 @@
+//============================================================================
+// Name        : BloomFilter.cpp
+// Author      : Connor Sculthorpe
+// Version     : 1.0
+// Description : Blocked Bloom filter over bid ids, answers "definitely not
+//               here" before a container is searched
+//============================================================================
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include "BloomFilter.hpp"
+
+using namespace std;
+
+/**
+ * splitmix64 finalizer, every key bit reaches every hash bit
+ */
+uint64_t BloomFilter::mix(uint64_t key) {
+	key += 0x9E3779B97F4A7C15ULL;
+	key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	key = (key ^ (key >> 27)) * 0x94D049BB133111EBULL;
+	return key ^ (key >> 31);
+}
+
+/**
+ * The block a hash falls in, from its high half by multiply and shift
+ */
+size_t BloomFilter::blockIndex(uint64_t hash) const {
+	return ((hash >> 32) * blocks.size()) >> 32;
+}
+
+/**
+ * Size the filter and empty it
+ *
+ * @param expected Number of keys it should hold at the given rate
+ * @param falsePositiveRate Chance a key that was never added passes, between 0 and 1
+ */
+void BloomFilter::Build(size_t expected, double falsePositiveRate) {
+	expected = max<size_t>(expected, 64);
+	falsePositiveRate = min(max(falsePositiveRate, 1e-6), 0.5);
+
+	// Textbook sizing. Confining a key to one block costs some accuracy, a fifth more bits wins it back
+	double bitsPerKey = -log(falsePositiveRate) / (log(2.0) * log(2.0)) * 1.2;
+	hashes = static_cast<unsigned int>(min(max(lround(bitsPerKey / 1.2 * log(2.0)), 1L), 16L));
+	blocks.assign(static_cast<size_t>(ceil(expected * bitsPerKey / 512)), Block());
+	capacity = expected;
+	size = 0;
+}
+
+/**
+ * Drop every key and the filter itself, lookups pass everything until the next Build()
+ */
+void BloomFilter::Clear() {
+	vector<Block>().swap(blocks);
+	capacity = 0;
+	size = 0;
+}
+
+/**
+ * Add a key
+ */
+void BloomFilter::Add(uint32_t key) {
+	if (blocks.empty()) {
+		return;
+	}
+	uint64_t hash = mix(key);
+	Block& target = blocks[blockIndex(hash)];
+	uint64_t bits = mix(hash); // 9 bits per position, 7 positions before it is mixed again
+	for (unsigned int i = 0; i < hashes; ++i) {
+		if (i != 0 && i % 7 == 0) {
+			bits = mix(bits);
+		}
+		unsigned int bit = bits & 511;
+		target.words[bit >> 6] |= uint64_t(1) << (bit & 63);
+		bits >>= 9;
+	}
+	++size;
+}
+
+/**
+ * Whether a key may have been added, false means it definitely wasn't
+ */
+bool BloomFilter::MayContain(uint32_t key) {
+	if (blocks.empty()) {
+		return true;
+	}
+	++lookups;
+	uint64_t hash = mix(key);
+	const Block& target = blocks[blockIndex(hash)];
+	uint64_t bits = mix(hash);
+	for (unsigned int i = 0; i < hashes; ++i) {
+		if (i != 0 && i % 7 == 0) {
+			bits = mix(bits);
+		}
+		unsigned int bit = bits & 511;
+		if ((target.words[bit >> 6] & (uint64_t(1) << (bit & 63))) == 0) {
+			++rejected;
+			return false;
+		}
+		bits >>= 9;
+	}
+	return true;
+}
+
+/**
+ * Called by the container when a key the filter passed wasn't there after all
+ */
+void BloomFilter::RecordFalsePositive() {
+	++falsePositives;
+}
+
+/**
+ * Whether the filter has been built
+ */
+bool BloomFilter::Enabled() const {
+	return !blocks.empty();
+}
+
+/**
+ * Keys added since the last Build()
+ */
+size_t BloomFilter::Size() const {
+	return size;
+}
+
+/**
+ * Keys the filter was sized for, past this the false positive rate climbs
+ */
+size_t BloomFilter::Capacity() const {
+	return capacity;
+}
+
+/**
+ * Memory held by the bit blocks
+ */
+size_t BloomFilter::Bytes() const {
+	return blocks.size() * sizeof(Block);
+}
+
+/**
+ * Print the filter's size and how the lookups went
+ */
+void BloomFilter::PrintStats() const {
+	if (blocks.empty()) {
+		cout << "Bloom filter: off" << endl;
+		return;
+	}
+	cout << "Bloom filter: " << size << "/" << capacity << " keys, " << Bytes() << " bytes, "
+		<< hashes << " bits set per key" << endl;
+	cout << "  lookups: " << lookups << ", definitely absent: " << rejected
+		<< ", passed on: " << lookups - rejected << ", false positives: " << falsePositives << endl;
+	if (rejected + falsePositives > 0) {
+		cout << "  false positive rate: " << double(falsePositives) / (rejected + falsePositives) << endl;
+	}
+}
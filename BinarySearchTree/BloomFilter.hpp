@@ -0,0 +1,55 @@
+//============================================================================
+// Name        : BloomFilter.hpp
+// Author      : Connor Sculthorpe
+// Version     : 1.0
+// Description : Blocked Bloom filter over bid ids, answers "definitely not
+//               here" before a container is searched
+//============================================================================
+
+#ifndef BLOOMFILTER_HPP
+#define BLOOMFILTER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+const double DEFAULT_FALSE_POSITIVE_RATE = 0.01;
+
+/**
+ * Every key sets its bits inside one 64 byte block, so a lookup reads a
+ * single cache line. Keys can't be taken out again, a removed key only
+ * costs an extra false positive until the next Build().
+ */
+class BloomFilter {
+
+private:
+	struct alignas(64) Block {
+		uint64_t words[8]; // 512 bits
+	};
+
+	std::vector<Block> blocks;
+	unsigned int hashes = 0; // bits set per key
+	size_t capacity = 0; // keys the filter was sized for
+	size_t size = 0; // keys added since Build()
+
+	uint64_t lookups = 0;
+	uint64_t rejected = 0; // lookups answered "definitely absent"
+	uint64_t falsePositives = 0; // lookups passed on that the container didn't have
+
+	static uint64_t mix(uint64_t key);
+	size_t blockIndex(uint64_t hash) const;
+
+public:
+	void Build(size_t expected, double falsePositiveRate);
+	void Clear();
+	void Add(uint32_t key);
+	bool MayContain(uint32_t key);
+	void RecordFalsePositive();
+	bool Enabled() const;
+	size_t Size() const;
+	size_t Capacity() const;
+	size_t Bytes() const;
+	void PrintStats() const;
+};
+
+#endif // BLOOMFILTER_HPP
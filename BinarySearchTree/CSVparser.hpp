@@ -3,9 +3,17 @@
 
 # include <stdexcept>
 # include <string>
+# include <string_view>
 # include <vector>
 # include <list>
+# include <cstddef>
+# include <memory>
+# include <fstream>
 # include <sstream>
+# include <charconv>
+# include <type_traits>
+
+# include "Arena.hpp"
 
 namespace csv
 {
@@ -19,36 +27,136 @@ namespace csv
         }
     };
 
+    /*
+    ** Read-only memory mapping of a whole file.
+    ** The mapping lives until close() or destruction.
+    */
+    class MappedFile
+    {
+      public:
+        MappedFile(void);
+        ~MappedFile(void);
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+      public:
+        void open(const std::string &);
+        void close(void);
+        const char *data(void) const;
+        std::size_t size(void) const;
+
+      private:
+        const char *_data;
+        std::size_t _size;
+# ifdef _WIN32
+        void *_file;
+        void *_mapping;
+# else
+        int _fd;
+# endif
+    };
+
+    /*
+    ** Column names of a file plus their trimmed form for lookups by name.
+    ** One instance is owned by the Parser/Stream and shared by all its rows.
+    ** When projecting, a column may list alternative names as "a|b".
+    */
+    class Header
+    {
+      public:
+        Header(void);
+        Header(const std::vector<std::string> &);
+
+      public:
+        unsigned int size(void) const;
+        int indexOf(std::string_view) const; // ignores surrounding spaces, -1 when there is no such column
+        const std::string &operator[](unsigned int) const;
+        const std::vector<std::string> &names(void) const;
+        std::vector<std::string>::const_iterator begin(void) const;
+        std::vector<std::string>::const_iterator end(void) const;
+
+      private:
+        std::vector<std::string> _names;
+        std::vector<std::string> _keys; // _names trimmed, a file has few enough columns to scan
+    };
+
+    struct Date
+    {
+        int year;
+        int month;
+        int day;
+    };
+
+    /*
+    ** Field conversions. None of them allocate, surrounding spaces are
+    ** ignored and false is returned when the text doesn't parse.
+    */
+    bool parseInteger(std::string_view, long long &);
+    bool parseDouble(std::string_view, double &);
+    bool parseCurrency(std::string_view, double &); // "$1,234.56 " -> 1234.56
+    bool parsePercent(std::string_view, double &); // "23%" -> 0.23, "0.23" -> 0.23
+    bool parseDate(std::string_view, Date &); // "2/18/2016", month/day/year
+
+    /*
+    ** A row is a small handle: its field views and any text it owns live in
+    ** the Arena of the Parser/Stream that made it, so rows are never freed
+    ** one by one.
+    */
     class Row
     {
     	public:
-    	    Row(const std::vector<std::string> &);
+    	    Row(const Header &, Arena &);
     	    ~Row(void);
 
     	public:
             unsigned int size(void) const;
             void push(const std::string &);
-            bool set(const std::string &, const std::string &); 
+            void pushView(std::string_view);
+            void setView(unsigned int, std::string_view);
+            void resize(unsigned int);
+            void reserve(unsigned int);
+            void clear(void);
+            bool set(const std::string &, const std::string &);
+            std::string_view view(unsigned int) const;
+            const Header &header(void) const;
 
     	private:
-    		const std::vector<std::string> _header;
-    		std::vector<std::string> _values;
+    		const Header *_header;
+    		Arena *_arena;
+    		std::string_view *_values; // in _arena
+    		unsigned int _size;
+    		unsigned int _capacity;
+
+    		friend class Parser;
 
         public:
 
             template<typename T>
             const T getValue(unsigned int pos) const
             {
-                if (pos < _values.size())
+                if (pos < _size)
                 {
-                    T res;
-                    std::stringstream ss;
-                    ss << _values[pos];
-                    ss >> res;
+                    T res = T();
+                    if constexpr (std::is_integral<T>::value && !std::is_same<T, bool>::value)
+                    {
+                        std::string_view v = _values[pos];
+                        std::from_chars(v.data(), v.data() + v.size(), res);
+                    }
+                    else
+                    {
+                        std::stringstream ss;
+                        ss << _values[pos];
+                        ss >> res;
+                    }
                     return res;
                 }
                 throw Error("can't return this value (doesn't exist)");
             }
+            long long getInteger(unsigned int) const;
+            double getDouble(unsigned int) const;
+            double getCurrency(unsigned int) const;
+            double getPercent(unsigned int) const;
+            Date getDate(unsigned int) const;
             const std::string operator[](unsigned int) const;
             const std::string operator[](const std::string &valueName) const;
             friend std::ostream& operator<<(std::ostream& os, const Row &row);
@@ -57,14 +165,19 @@ namespace csv
 
     enum DataType {
         eFILE = 0,
-        ePURE = 1
+        ePURE = 1,
+        eMAPPED = 2 // zero-copy, read-only: rows are views into the mapped file, sync() is a no-op
     };
 
     class Parser
     {
 
     public:
-        Parser(const std::string &, const DataType &type = eFILE, char sep = ',');
+        // threads > 1 parses that many byte ranges in parallel, 0 uses one per core
+        Parser(const std::string &, const DataType &type = eFILE, char sep = ',', unsigned int threads = 1);
+        // only the named columns are kept, in that order; see Header for "a|b" alternatives
+        Parser(const std::string &, const std::vector<std::string> &columns,
+               const DataType &type = eFILE, char sep = ',', unsigned int threads = 1);
         ~Parser(void);
 
     public:
@@ -81,20 +194,89 @@ namespace csv
         void sync(void) const;
 
     protected:
+    	void load(const std::string &);
     	void parseHeader(void);
     	void parseContent(void);
+    	void parseRange(std::string_view, std::vector<Row> &, Arena &) const;
 
     private:
         std::string _file;
         const DataType _type;
         const char _sep;
-        std::vector<std::string> _originalFile;
-        std::vector<std::string> _header;
-        std::vector<Row *> _content;
+        const unsigned int _threads;
+        std::string _buffer; // file or pure content, unused when mapped
+        MappedFile _map;
+        std::string_view _text; // whatever is being parsed, _buffer or _map
+        std::size_t _pos; // parse position in _text
+        std::size_t _sourceColumns; // columns in the file, _header may be a projection
+        const std::vector<std::string> _columns; // requested projection, empty for all
+        std::vector<int> _projection;
+        Header _header;
+        Arena _arena; // every row and field of _content
+        std::vector<Row> _content;
 
     public:
         Row &operator[](unsigned int row) const;
     };
+
+    /*
+    ** Forward-only reader that never holds the whole file:
+    **   for (csv::Row &row : csv::Stream(path)) ...
+    ** The file is read in fixed-size blocks and a single Row is reused,
+    ** so a row and its views are only valid until the next one is read.
+    */
+    class Stream
+    {
+
+    public:
+        class iterator
+        {
+        public:
+            iterator(Stream *stream);
+            Row &operator*(void) const;
+            Row *operator->(void) const;
+            iterator &operator++(void);
+            bool operator!=(const iterator &other) const;
+            bool operator==(const iterator &other) const;
+
+        private:
+            Stream *_stream; // nullptr once the stream is exhausted
+        };
+
+    public:
+        Stream(const std::string &, char sep = ',', std::size_t blockSize = 64 * 1024);
+        Stream(const std::string &, const std::vector<std::string> &columns,
+               char sep = ',', std::size_t blockSize = 64 * 1024);
+        ~Stream(void);
+        Stream(const Stream &) = delete;
+        Stream &operator=(const Stream &) = delete;
+
+    public:
+        iterator begin(void);
+        iterator end(void);
+        bool next(void);
+        Row &getRow(void) const;
+        unsigned int columnCount(void) const;
+        std::vector<std::string> getHeader(void) const;
+        const std::string &getFileName(void) const;
+
+    private:
+        void open(const std::vector<std::string> &columns);
+        bool readLine(std::string_view &line);
+
+    private:
+        std::string _file;
+        const char _sep;
+        std::ifstream _in;
+        std::vector<char> _block;
+        std::size_t _begin; // unconsumed bytes are _block[_begin, _end)
+        std::size_t _end;
+        std::size_t _sourceColumns;
+        std::vector<int> _projection;
+        Header _header;
+        Arena _arena; // the current row only, reset for every row
+        std::unique_ptr<Row> _row;
+    };
 }
 
 #endif /*!_CSVPARSER_HPP_*/
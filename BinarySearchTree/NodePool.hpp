@@ -0,0 +1,130 @@
+//============================================================================
+// Name        : NodePool.hpp
+// Author      : Connor Sculthorpe
+// Version     : 1.0
+// Description : Fixed-size node allocator for linked containers, nodes are
+//               carved from large blocks and given back all at once
+//============================================================================
+
+#ifndef NODEPOOL_HPP
+#define NODEPOOL_HPP
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "Arena.hpp"
+
+/**
+ * Nodes are carved one after another out of an Arena, so nodes made
+ * together sit together in memory. A released node goes on a free list and
+ * is handed out again before the arena is carved any further.
+ *
+ * Nothing goes back to the system until Clear() or destruction, which drop
+ * every node at once without visiting them, so T must not need a destructor.
+ * A pool is not thread safe; threads building together each use their own
+ * and Merge() them afterwards.
+ */
+template <typename T>
+class NodePool {
+	static_assert(std::is_trivially_destructible<T>::value, "NodePool never runs destructors");
+
+private:
+	union Slot {
+		Slot* next; // while on the free list
+		alignas(T) unsigned char node[sizeof(T)];
+	};
+
+	csv::Arena arena;
+	Slot* freeList = nullptr;
+	size_t live = 0; // nodes handed out and not released
+	size_t carved = 0; // nodes carved from the arena, live or on the free list
+
+public:
+	NodePool(size_t blockSize = 64 * 1024) : arena(blockSize) {
+	}
+
+	NodePool(const NodePool&) = delete;
+	NodePool& operator=(const NodePool&) = delete;
+
+	/**
+	 * Make a node, reusing a released one first
+	 *
+	 * @param args Passed on to T's constructor
+	 */
+	template <typename... Args>
+	T* Allocate(Args&&... args) {
+		void* memory;
+		if (freeList != nullptr) {
+			memory = freeList;
+			freeList = freeList->next;
+		}
+		else {
+			memory = arena.allocate(sizeof(Slot), alignof(Slot));
+			++carved;
+		}
+		++live;
+		return new (memory) T(std::forward<Args>(args)...);
+	}
+
+	/**
+	 * Give a node back, it is reused by the next Allocate()
+	 *
+	 * @param node A node from this pool, or from one merged into it
+	 */
+	void Release(T* node) {
+		Slot* slot = reinterpret_cast<Slot*>(node);
+		slot->next = freeList;
+		freeList = slot;
+		--live;
+	}
+
+	/**
+	 * Drop every node at once, the blocks are kept and carved again
+	 */
+	void Clear() {
+		arena.reset();
+		freeList = nullptr;
+		live = 0;
+		carved = 0;
+	}
+
+	/**
+	 * Take over another pool's nodes, they are released from this one from now on
+	 *
+	 * @param other The pool to empty, it can be used again afterwards
+	 */
+	void Merge(NodePool& other) {
+		arena.merge(other.arena);
+		if (other.freeList != nullptr) { // its free nodes go in front of ours
+			Slot* last = other.freeList;
+			while (last->next != nullptr) {
+				last = last->next;
+			}
+			last->next = freeList;
+			freeList = other.freeList;
+		}
+		live += other.live;
+		carved += other.carved;
+		other.freeList = nullptr;
+		other.live = 0;
+		other.carved = 0;
+	}
+
+	/**
+	 * Number of nodes handed out and not released
+	 */
+	size_t Size() const {
+		return live;
+	}
+
+	/**
+	 * Memory taken by the nodes carved so far, free ones included
+	 */
+	size_t Bytes() const {
+		return carved * sizeof(Slot);
+	}
+};
+
+#endif // NODEPOOL_HPP
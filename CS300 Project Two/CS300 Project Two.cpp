@@ -14,6 +14,9 @@
 */
 
 
+#include <algorithm> // sort, min, max
+#include <cstdint>
+#include <cstring> // memcpy
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -173,7 +176,7 @@ class BST {
 		Course course;
 		Node* left;
 		Node* right;
-		int height; // Field to store AVL implementation height association
+		int height; // Nodes on the longest path down from here, kept by the AVL rotations
 
 		Node() { // Default constructor
 			left = nullptr;
@@ -187,7 +190,7 @@ class BST {
 	};
 private:
 	Node* root;
-	void InsertItem(Node* node, Course aCourse);
+	Node* InsertItem(Node* node, Course aCourse);
 	void InOrderHelper(Node* node);
 	void PreOrderHelper(Node* node);
 	void PostOrderHelper(Node* node);
@@ -195,6 +198,11 @@ private:
 	Node* removeNode(Node* node, string courseNumber);
 	int TreeSize;
 	void vectorPrinter(vector<string> Vector);
+	static int Height(Node* node);
+	static void UpdateHeight(Node* node);
+	static Node* RotateLeft(Node* node);
+	static Node* RotateRight(Node* node);
+	static Node* Rebalance(Node* node);
 
 public:
 	BST();
@@ -209,32 +217,111 @@ public:
 };
 
 /**
- * Adds a node with course to the tree
+ * Adds a node with course to the tree, rebalancing on the way back up
  *
  * Time: O(log n)
- * Space: O(n)
- * @param Node* node to be referenced from
+ * Space: O(log n)
+ * @param Node* node to be referenced from, nullptr where the course goes
  * @param Course aCourse to be added
+ * @return Node* now at the top of this subtree
  */
-void BST::InsertItem(Node* node, Course aCourse) {
-	if (node->course.courseTitle > aCourse.courseTitle) { // If the existing course number is greater than the one to be inserted
-		if (node->left == nullptr) { // Left subtree has no lesser node
-			node->left = new Node(aCourse); // Construct a new node and make it the left pointer of the current node
-			this->TreeSize = this->TreeSize + 1; // Tree size has increased by one node
-		}
-		else { // Left not nullptr, exists
-			InsertItem(node->left, aCourse); // Recurse leftward
-		}
+BST::Node* BST::InsertItem(Node* node, Course aCourse) {
+	if (node == nullptr) { // Found the empty spot
+		this->TreeSize = this->TreeSize + 1; // Tree size has increased by one node
+		return new Node(aCourse); // Construct a new node, the caller links it in
+	}
+
+	if (node->course.courseNumber > aCourse.courseNumber) { // If the existing course number is greater than the one to be inserted
+		node->left = InsertItem(node->left, aCourse); // Recurse leftward
 	}
 	else { // Existing course number is less than the one to be inserted
-		if (node->right == nullptr) { // Right subtree has no lesser node
-			node->right = new Node(aCourse); // Construct a new node and make it the right pointer of the current node
-			this->TreeSize = this->TreeSize + 1; // Tree size has increased by one node
+		node->right = InsertItem(node->right, aCourse); // Recurse rightward
+	}
+	return Rebalance(node);
+}
+
+/**
+ * Height of a subtree
+ *
+ * Time: O(1)
+ * Space: O(1)
+ * @param Node* node at the top of the subtree, may be nullptr
+ * @return int 0 for an empty subtree
+ */
+int BST::Height(Node* node) {
+	return node == nullptr ? 0 : node->height;
+}
+
+/**
+ * Recompute a node's height from its children
+ *
+ * Time: O(1)
+ * Space: O(1)
+ * @param Node* node to update
+ */
+void BST::UpdateHeight(Node* node) {
+	node->height = 1 + max(Height(node->left), Height(node->right));
+}
+
+/**
+ * Lift the right child above the node
+ *
+ * Time: O(1)
+ * Space: O(1)
+ * @param Node* node with a right child
+ * @return Node* new top of the subtree
+ */
+BST::Node* BST::RotateLeft(Node* node) {
+	Node* pivot = node->right;
+	node->right = pivot->left;
+	pivot->left = node;
+	UpdateHeight(node); // Now below the pivot, so it goes first
+	UpdateHeight(pivot);
+	return pivot;
+}
+
+/**
+ * Lift the left child above the node
+ *
+ * Time: O(1)
+ * Space: O(1)
+ * @param Node* node with a left child
+ * @return Node* new top of the subtree
+ */
+BST::Node* BST::RotateRight(Node* node) {
+	Node* pivot = node->left;
+	node->left = pivot->right;
+	pivot->right = node;
+	UpdateHeight(node);
+	UpdateHeight(pivot);
+	return pivot;
+}
+
+/**
+ * Fix a node's height after a subtree changed, rotating once or twice
+ * when one side is two taller than the other
+ *
+ * Time: O(1)
+ * Space: O(1)
+ * @param Node* node whose children are already balanced
+ * @return Node* now at the top of this subtree
+ */
+BST::Node* BST::Rebalance(Node* node) {
+	UpdateHeight(node);
+	int balance = Height(node->left) - Height(node->right);
+	if (balance > 1) { // Left heavy
+		if (Height(node->left->left) < Height(node->left->right)) { // Left-right, straighten it first
+			node->left = RotateLeft(node->left);
 		}
-		else { // Right nmot nullptr, exists
-			InsertItem(node->right, aCourse); // Recurse rightward
+		return RotateRight(node);
+	}
+	if (balance < -1) { // Right heavy
+		if (Height(node->right->right) < Height(node->right->left)) { // Right-left
+			node->right = RotateRight(node->right);
 		}
+		return RotateLeft(node);
 	}
+	return node;
 }
 
 /**
@@ -360,68 +447,66 @@ void BST::DeconstructorHelper(Node* node) {
  * Insert a course
  *
  * Time: O(log n)
- * Space: O(n)
+ * Space: O(log n)
  * @param int Course to be inserted
  */
 void BST::Insert(Course aCourse) {
-	if (root == nullptr) { // Root does not exist
-		root = new Node(aCourse); // Make the new node root
-		this->TreeSize = this->TreeSize + 1;
-	}
-	else {
-		InsertItem((this->root), aCourse); // Add by passing the root as reference since node was not specified
-	}
+	this->root = InsertItem(this->root, aCourse); // The root moves when a rotation reaches it
 }
 
 /**
  * Recursively remove a course
  * Passes node information to removeNode(Node* node, int courseNumber).
  *
- * Time: O(n)
- * Space: O(n), θ(log n)
+ * Time: O(log n)
+ * Space: O(log n)
  * @param int courseNumber to be removed
  */
 void BST::Remove(string courseNumber) {
-	this->removeNode(root, courseNumber); // Calls the helper function to remove the node
+	this->root = this->removeNode(root, courseNumber); // Calls the helper function to remove the node
 	cout << "Removed " + courseNumber << endl; // Outputs a message indicating the successful removal
-	this->TreeSize = this->TreeSize - 1; // Decrements the size of the tree
 	return;
 }
 
 
 /**
- * Recursively remove a course from the tree
+ * Recursively remove a course from the tree, rebalancing on the way back up
  *
- * Time: O(n)
- * Space: O(n), θ(log n)
+ * Time: O(log n)
+ * Space: O(log n)
  * @param Node* node to reference from
  * @param int Course to be removed
+ * @return Node* now at the top of this subtree
  */
 BST::Node* BST::removeNode(Node* node, string courseNumber) {
 	if (node == nullptr) { // If we have a blank for a node
 		return nullptr; // Then do not try to remove it
 	}
 
-	if (node->course.courseNumber < courseNumber) { // If the existing course number is greater than the one to be removed
+	if (node->course.courseNumber > courseNumber) { // If the existing course number is greater than the one to be removed
 		node->left = removeNode(node->left, courseNumber); // Recurse down and replace the removed node
 	}
-	else if (node->course.courseNumber > courseNumber) { // Course for removal is larger, go right
+	else if (node->course.courseNumber < courseNumber) { // Course for removal is larger, go right
 		node->right = removeNode(node->right, courseNumber); // Recurse down and replace the removed node
 	}
 	else { // Match found
 		if (node->left == nullptr && node->right == nullptr) { // leaf case
 			delete node;
 			node = nullptr; // Keep the pointer safe
+			this->TreeSize = this->TreeSize - 1; // Only counted where a node is deleted, the two child case copies
 			return nullptr;
 		}
 		else if (node->left != nullptr && node->right == nullptr) { // Right is null case ("Case 4")
 			Node* temp = node;
 			node = node->left;
 			delete temp;
+			this->TreeSize = this->TreeSize - 1;
 		}
 		else if (node->left == nullptr && node->right != nullptr) { // Left is null case ("Case 3")
 			Node* temp = node;
 			node = node->right;
+			delete temp;
+			this->TreeSize = this->TreeSize - 1;
 		}
 		else { // Two children case ("Case 1")
 			Node* temp = node->right;
@@ -432,14 +517,14 @@ BST::Node* BST::removeNode(Node* node, string courseNumber) {
 			node->right = removeNode(node->right, temp->course.courseNumber); // Recursively remove successor since it was copied
 		}
 	}
-	return node;
+	return Rebalance(node);
 }
 
 /**
  * Searches a course from the tree
  *
- * Time: O(n)
- * Space: O(n)
+ * Time: O(log n)
+ * Space: O(1)
  * @param int Course to be searched for
  */
 void BST::Search(string courseNumber) {
@@ -454,10 +539,10 @@ void BST::Search(string courseNumber) {
 			return;
 			//return currNode->course; // Return the currently held course that matched
 		}
-		else if (currNode->course.courseNumber < courseNumber) { // The check is less than what was checked against
+		else if (currNode->course.courseNumber > courseNumber) { // The check is greater than what was checked against
 			currNode = currNode->left; // Shift loop left
 		}
-		else { // current > courseNumber checked against
+		else { // current < courseNumber checked against
 			currNode = currNode->right; // Shift loop right
 		} // Continue looping
 	} // Current is nullptr, match is not found
@@ -482,10 +567,200 @@ void BST::vectorPrinter(vector<string> Vector) {
 }
 
 
+//============================================================================
+// Hash policies
+//============================================================================
+// A hash policy turns a course number into a 64-bit hash (Hash) and reduces it to a bucket for a table of any size (Range).
+// HashTable uses CourseHash, pick another policy at compile time with e.g. /DCOURSE_HASH=CharSumHash
+
+/**
+ * The original hash: the sum of the characters, reduced with %.
+ * Course numbers share a prefix and differ in a few digits, so they pile into a handful of buckets.
+ *
+ * Time: O(n) in the key length
+ * Space: O(1)
+ */
+struct CharSumHash {
+	static uint64_t Hash(const string& key) {
+		uint64_t hash = 0;
+		for (char ch : key) {
+			hash += static_cast<unsigned int>(ch); // Convert the character to an integer and add it to the hash
+		}
+		return hash;
+	}
+
+	static unsigned int Range(uint64_t hash, unsigned int size) {
+		return hash % size; // Modulo the hash to fit within the table size
+	}
+};
+
+/**
+ * wyhash-style mixing over the bytes of the key. Every step is a 64 x 64 -> 128 bit multiply folded back
+ * to 64 bits, so each input bit reaches every output bit. Range uses the high half with a multiply and shift
+ * in place of a division.
+ *
+ * Time: O(n) in the key length
+ * Space: O(1)
+ */
+struct WyHash {
+	static uint64_t Hash(const string& key) {
+		return Bytes(key.data(), key.size(), 0);
+	}
+
+	static unsigned int Range(uint64_t hash, unsigned int size) {
+		return ((hash >> 32) * size) >> 32;
+	}
+
+	static uint64_t Bytes(const void* data, size_t length, uint64_t seed);
+
+private:
+	static void multiply(uint64_t& a, uint64_t& b);
+	static uint64_t mix(uint64_t a, uint64_t b);
+	static uint64_t read64(const uint8_t* p);
+	static uint64_t read32(const uint8_t* p);
+};
+
+const uint64_t WYHASH_SECRET[4] = { 0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL,
+	0x8ebc6af09c88c6e3ULL, 0x589965cc75374cc3ULL };
+
+/**
+ * Full 128-bit product of a and b, a gets the low half and b the high half.
+ *
+ * Time: O(1)
+ * Space: O(1)
+ */
+void WyHash::multiply(uint64_t& a, uint64_t& b) {
+#if defined(__SIZEOF_INT128__)
+	unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+	a = static_cast<uint64_t>(product);
+	b = static_cast<uint64_t>(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+	a = _umul128(a, b, &b);
+#else // four 32 x 32 bit products
+	uint64_t aHigh = a >> 32, aLow = static_cast<uint32_t>(a);
+	uint64_t bHigh = b >> 32, bLow = static_cast<uint32_t>(b);
+	uint64_t highHigh = aHigh * bHigh, highLow = aHigh * bLow;
+	uint64_t lowHigh = aLow * bHigh, lowLow = aLow * bLow;
+	uint64_t middle = (lowLow >> 32) + static_cast<uint32_t>(highLow) + static_cast<uint32_t>(lowHigh);
+	a = (middle << 32) | static_cast<uint32_t>(lowLow);
+	b = highHigh + (highLow >> 32) + (lowHigh >> 32) + (middle >> 32);
+#endif
+}
+
+/**
+ * 128-bit product of a and b with the halves xored together.
+ *
+ * Time: O(1)
+ * Space: O(1)
+ */
+uint64_t WyHash::mix(uint64_t a, uint64_t b) {
+	multiply(a, b);
+	return a ^ b;
+}
+
+uint64_t WyHash::read64(const uint8_t* p) {
+	uint64_t value;
+	memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+uint64_t WyHash::read32(const uint8_t* p) {
+	uint32_t value;
+	memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+/**
+ * Hash any run of bytes.
+ *
+ * Time: O(n)
+ * Space: O(1)
+ * @param const void* data: The bytes to hash.
+ * @param size_t length: Number of bytes.
+ * @param uint64_t seed: Starting value, different seeds give unrelated hashes.
+ * @return uint64_t: The hash.
+ */
+uint64_t WyHash::Bytes(const void* data, size_t length, uint64_t seed) {
+	const uint8_t* p = static_cast<const uint8_t*>(data);
+	seed ^= mix(seed ^ WYHASH_SECRET[0], WYHASH_SECRET[1]);
+
+	uint64_t a = 0;
+	uint64_t b = 0;
+	if (length <= 16) {
+		if (length >= 4) { // two overlapping reads from each end cover 4 to 16 bytes
+			size_t shift = (length >> 3) << 2;
+			a = (read32(p) << 32) | read32(p + shift);
+			b = (read32(p + length - 4) << 32) | read32(p + length - 4 - shift);
+		}
+		else if (length > 0) {
+			a = (uint64_t(p[0]) << 16) | (uint64_t(p[length >> 1]) << 8) | p[length - 1];
+		}
+	}
+	else {
+		size_t left = length;
+		while (left > 16) { // 16 bytes per step
+			seed = mix(read64(p) ^ WYHASH_SECRET[1], read64(p + 8) ^ seed);
+			p += 16;
+			left -= 16;
+		}
+		a = read64(p + left - 16); // the last 16 bytes, may overlap what was already mixed
+		b = read64(p + left - 8);
+	}
+
+	a ^= WYHASH_SECRET[1];
+	b ^= seed;
+	multiply(a, b);
+	return mix(a ^ WYHASH_SECRET[0] ^ length, b ^ WYHASH_SECRET[1]);
+}
+
+#ifndef COURSE_HASH
+#define COURSE_HASH WyHash
+#endif
+typedef COURSE_HASH CourseHash;
+
+
 //============================================================================
 // Hash Table methods
 //============================================================================
 
+/**
+ * Shape of the hash table at one moment, from HashTable::Stats().
+ * Probe counts are what a search would read given the layout, nothing is counted while searching.
+ */
+struct HashTableStats {
+	static const unsigned int HISTOGRAM_SIZE = 9; // Chains of 0 to 7 courses, then 8 or more
+
+	unsigned int buckets = 0;
+	unsigned int count = 0;
+	float loadFactor = 0;
+	unsigned int chainLengths[HISTOGRAM_SIZE] = {}; // Number of buckets holding each number of courses
+	unsigned int maxProbe = 0; // Courses read by the slowest search, the longest chain
+	double probesPerHit = 0; // Courses read to find a stored course, averaged over the courses
+	double probesPerMiss = 0; // Courses read to rule out a missing one, averaged over the buckets
+	unsigned int tombstones = 0; // Removal unlinks from the chain, so always 0 for chaining
+	size_t bytes = 0; // Buckets and chain nodes, not the text the courses own
+
+	void Print() const;
+};
+
+/**
+ * Print the stats, the histogram on one line
+ *
+ * Time: O(1)
+ * Space: O(1)
+ */
+void HashTableStats::Print() const {
+	cout << "Hash table: " << count << " courses in " << buckets << " buckets, load factor " << loadFactor << endl;
+	cout << "  chain lengths:";
+	for (unsigned int length = 0; length < HISTOGRAM_SIZE; ++length) {
+		cout << " " << length << (length == HISTOGRAM_SIZE - 1 ? "+" : "") << ":" << chainLengths[length];
+	}
+	cout << endl;
+	cout << "  longest probe: " << maxProbe << ", probes per hit: " << probesPerHit
+		<< ", probes per miss: " << probesPerMiss << endl;
+	cout << "  tombstones: " << tombstones << ", memory: " << bytes << " bytes" << endl;
+}
+
 class HashTable {
 private:
 	const unsigned int DEFAULT_SIZE = 97; // Largest 2 digit prime as a default constant
@@ -529,6 +804,7 @@ public:
 	void SearchHash(string courseNumber);
 	void PrintHash();
 	void PrintHashInOrder();
+	HashTableStats Stats() const;
 };
 
 
@@ -585,12 +861,7 @@ HashTable::~HashTable() {
  * @return int: The hash value.
  */
 unsigned int HashTable::Hash(string courseNumber) {
-	unsigned int hash = 0;
-	for (char ch : courseNumber) {
-		hash += static_cast<unsigned int>(ch); // Convert the character to an integer and add it to the hash
-	}
-	hash %= tableSize; // Modulo the hash to fit within the table size
-	return hash;
+	return CourseHash::Range(CourseHash::Hash(courseNumber), tableSize); // Hash with the chosen policy, then fit within the table size
 }
 
 /**
@@ -601,7 +872,7 @@ unsigned int HashTable::Hash(string courseNumber) {
  * @return bool: True if the hash table is empty, false otherwise.
  */
 bool HashTable::IsEmpty() {
-	for (const htNode node : nodes) {
+	for (const htNode& node : nodes) {
 		if (node.key != UINT_MAX) {
 			return false; // Non-empty slot found
 		}
@@ -767,6 +1038,44 @@ void HashTable::PrintHashInOrder() {
 }
 
 
+/**
+ * Measure the table in one pass over the buckets and chains. Nothing is allocated or changed,
+ * so it can be called every so often to catch a hash that piles courses into a few buckets.
+ *
+ * Time: O(n + m), m buckets
+ * Space: O(1)
+ * @return HashTableStats: Load factor, chain lengths, probe counts and memory.
+ */
+HashTableStats HashTable::Stats() const {
+	HashTableStats stats;
+	double hitProbes = 0;
+	double missProbes = 0;
+	size_t chainNodes = 0;
+
+	for (const htNode& head : nodes) {
+		unsigned int length = 0;
+		for (const htNode* current = &head; current != nullptr; current = current->next) {
+			if (current->key != UINT_MAX) { // An empty head can still lead a chain after a removal
+				++length;
+			}
+		}
+		chainNodes += length > 0 && head.key != UINT_MAX ? length - 1 : length;
+		stats.count += length;
+		++stats.chainLengths[min(length, HashTableStats::HISTOGRAM_SIZE - 1)];
+		stats.maxProbe = max(stats.maxProbe, length);
+		hitProbes += length * (length + 1) / 2.0; // The i-th course of a chain is found after i reads
+		missProbes += max(length, 1u); // A miss reads the whole chain, or just the empty head
+	}
+
+	stats.buckets = static_cast<unsigned int>(nodes.size());
+	stats.loadFactor = stats.buckets != 0 ? stats.count / float(stats.buckets) : 0;
+	stats.probesPerHit = stats.count != 0 ? hitProbes / stats.count : 0;
+	stats.probesPerMiss = stats.buckets != 0 ? missProbes / stats.buckets : 0;
+	stats.bytes = sizeof(HashTable) + (nodes.capacity() + chainNodes) * sizeof(htNode);
+	return stats;
+}
+
+
 //============================================================================
 // Menu methods
 //============================================================================
@@ -883,6 +1192,9 @@ void Menu::InputMenu(string &filename) {
 			DataStructureReleaser(curLoaded);
 			curLoaded = 2; // Set flag for the hash table as the loaded element
 			CreateFromFile(filename, curLoaded); // Load the hash table
+			if (courseTable != nullptr) {
+				courseTable->Stats().Print(); // Shows a bad spread as soon as the table is loaded
+			}
 			
 			break;
 
@@ -0,0 +1,42 @@
+#ifndef     _ARENA_HPP_
+# define    _ARENA_HPP_
+
+# include <cstddef>
+# include <string_view>
+# include <vector>
+
+namespace csv
+{
+    /*
+    ** Bump allocator: memory is carved out of large blocks and only given
+    ** back all at once, by reset() or destruction.
+    */
+    class Arena
+    {
+      public:
+        Arena(std::size_t blockSize = 64 * 1024);
+        ~Arena(void);
+        Arena(const Arena &) = delete;
+        Arena &operator=(const Arena &) = delete;
+
+      public:
+        void *allocate(std::size_t size, std::size_t align = alignof(std::max_align_t));
+        std::string_view copy(std::string_view); // text owned by the arena
+        void reset(void); // everything handed out so far is released, blocks are reused
+        void merge(Arena &); // takes over the other arena's memory
+
+      private:
+        struct Block
+        {
+            char *data;
+            std::size_t size;
+        };
+
+        std::vector<Block> _blocks;
+        std::size_t _current; // block being carved, earlier blocks are full
+        std::size_t _used; // bytes used in the current block
+        const std::size_t _blockSize;
+    };
+}
+
+#endif /*!_ARENA_HPP_*/
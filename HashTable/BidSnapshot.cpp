@@ -0,0 +1,255 @@
+//============================================================================
+// Name        : BidSnapshot.cpp
+// Author      : Connor Sculthorpe
+// Version     : 1.0
+// Description : Binary snapshot of a parsed bid file, loaded instead of the
+//               CSV while the CSV is unchanged
+//============================================================================
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+#include "BidSnapshot.hpp"
+
+using namespace std;
+
+namespace {
+
+const char SNAPSHOT_MAGIC[8] = { 'B', 'I', 'D', 'S', 'N', 'A', 'P', '\0' };
+const uint32_t SNAPSHOT_VERSION = 2; // 2: numeric ids and amounts in cents
+
+/**
+ * FNV-1a, continued from a previous hash
+ *
+ * @param hash Hash so far
+ * @param data Bytes to add
+ * @param size Number of bytes
+ * @return The updated hash
+ */
+uint64_t checksum(uint64_t hash, const void* data, size_t size) {
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	for (size_t i = 0; i < size; ++i) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL; // FNV prime
+	}
+	return hash;
+}
+
+const uint64_t CHECKSUM_SEED = 14695981039346656037ULL; // FNV offset basis
+
+/**
+ * Size and last write time of the CSV, what a snapshot is checked against
+ *
+ * @return false if the file can't be read
+ */
+bool sourceStamp(const string& csvPath, uint64_t& size, int64_t& time) {
+	error_code error;
+	uintmax_t fileSize = filesystem::file_size(csvPath, error);
+	if (error) {
+		return false;
+	}
+	filesystem::file_time_type writeTime = filesystem::last_write_time(csvPath, error);
+	if (error) {
+		return false;
+	}
+	size = fileSize;
+	time = static_cast<int64_t>(writeTime.time_since_epoch().count());
+	return true;
+}
+
+} // namespace
+
+//============================================================================
+// BidSnapshot
+//============================================================================
+
+/**
+ * Default constructor, nothing is mapped until Open()
+ */
+BidSnapshot::BidSnapshot() {
+	records = nullptr;
+	heap = nullptr;
+	count = 0;
+}
+
+/**
+ * Path of the snapshot that belongs to a CSV file
+ *
+ * @param csvPath The CSV file
+ * @return The snapshot path
+ */
+string BidSnapshot::PathFor(const string& csvPath) {
+	return csvPath + ".snap";
+}
+
+/**
+ * Map the snapshot of a CSV file if there is one and it is still fresh,
+ * meaning the CSV has the same size and write time and the data checksums.
+ *
+ * @param csvPath The CSV file the snapshot was made from
+ * @return true if the snapshot can be used instead of the CSV
+ */
+bool BidSnapshot::Open(const string& csvPath) {
+	records = nullptr;
+	heap = nullptr;
+	count = 0;
+
+	uint64_t size;
+	int64_t time;
+	if (!sourceStamp(csvPath, size, time) || !filesystem::exists(PathFor(csvPath))) {
+		return false;
+	}
+
+	try {
+		file.open(PathFor(csvPath));
+	}
+	catch (csv::Error&) {
+		return false;
+	}
+
+	if (file.size() < sizeof(BidSnapshotHeader)) {
+		file.close();
+		return false;
+	}
+	const BidSnapshotHeader* header = reinterpret_cast<const BidSnapshotHeader*>(file.data());
+	uint64_t bodySize = file.size() - sizeof(BidSnapshotHeader);
+
+	if (memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0
+		|| header->version != SNAPSHOT_VERSION
+		|| header->sourceSize != size || header->sourceTime != time // CSV changed since
+		|| header->heapSize > bodySize // checked apart so the sum below can't wrap
+		|| uint64_t(header->count) * sizeof(BidSnapshotRecord) != bodySize - header->heapSize
+		|| checksum(CHECKSUM_SEED, file.data() + sizeof(BidSnapshotHeader), bodySize) != header->checksum) {
+		file.close();
+		return false;
+	}
+
+	// The mapping is page aligned and every part is a multiple of 8 bytes, so the records can be read in place
+	const BidSnapshotRecord* body = reinterpret_cast<const BidSnapshotRecord*>(file.data() + sizeof(BidSnapshotHeader));
+
+	// The checksum only catches damage, every text must also lie inside the heap before text() trusts it
+	for (uint32_t i = 0; i < header->count; ++i) {
+		if (uint64_t(body[i].titleOffset) + body[i].titleLength > header->heapSize
+			|| uint64_t(body[i].fundOffset) + body[i].fundLength > header->heapSize) {
+			file.close();
+			return false;
+		}
+	}
+
+	records = body;
+	heap = file.data() + sizeof(BidSnapshotHeader) + header->count * sizeof(BidSnapshotRecord);
+	count = header->count;
+	return true;
+}
+
+/**
+ * Number of bids in the snapshot
+ */
+size_t BidSnapshot::Size() const {
+	return count;
+}
+
+/**
+ * Text in the heap, Open() has checked every record's text is inside it
+ */
+string_view BidSnapshot::text(uint32_t offset, uint32_t length) const {
+	return string_view(heap + offset, length);
+}
+
+uint32_t BidSnapshot::BidId(size_t i) const {
+	return records[i].bidId;
+}
+
+string_view BidSnapshot::Title(size_t i) const {
+	return text(records[i].titleOffset, records[i].titleLength);
+}
+
+string_view BidSnapshot::Fund(size_t i) const {
+	return text(records[i].fundOffset, records[i].fundLength);
+}
+
+int64_t BidSnapshot::Amount(size_t i) const {
+	return records[i].amount;
+}
+
+//============================================================================
+// BidSnapshotWriter
+//============================================================================
+
+/**
+ * Copy text into the heap. Past UINT32_MAX bytes the offsets no longer fit
+ * a record, Write() then refuses the snapshot.
+ *
+ * @return Offset of the text in the heap
+ */
+uint32_t BidSnapshotWriter::append(string_view text) {
+	uint32_t offset = static_cast<uint32_t>(heap.size());
+	heap.append(text.data(), text.size());
+	return offset;
+}
+
+/**
+ * Add a bid to the snapshot
+ */
+void BidSnapshotWriter::Add(uint32_t bidId, string_view title, string_view fund, int64_t amount) {
+	BidSnapshotRecord record;
+	record.bidId = bidId;
+	record.titleOffset = append(title);
+	record.titleLength = static_cast<uint32_t>(title.size());
+	record.fundOffset = append(fund);
+	record.fundLength = static_cast<uint32_t>(fund.size());
+	record.reserved = 0;
+	record.amount = amount;
+	records.push_back(record);
+}
+
+/**
+ * Write the snapshot next to the CSV it was built from.
+ * It goes to a temporary file first so a reader never maps half a snapshot.
+ *
+ * @param csvPath The CSV file the bids were read from
+ * @return false if the snapshot could not be written or is too big for the format
+ */
+bool BidSnapshotWriter::Write(const string& csvPath) const {
+	if (heap.size() > UINT32_MAX || records.size() > UINT32_MAX) { // too big for the record fields
+		return false;
+	}
+
+	BidSnapshotHeader header;
+	memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+	header.version = SNAPSHOT_VERSION;
+	header.count = static_cast<uint32_t>(records.size());
+	if (!sourceStamp(csvPath, header.sourceSize, header.sourceTime)) {
+		return false;
+	}
+
+	string padding((8 - heap.size() % 8) % 8, '\0'); // keep the file a multiple of 8 bytes
+	header.heapSize = heap.size() + padding.size();
+	header.checksum = checksum(CHECKSUM_SEED, records.data(), records.size() * sizeof(BidSnapshotRecord));
+	header.checksum = checksum(header.checksum, heap.data(), heap.size());
+	header.checksum = checksum(header.checksum, padding.data(), padding.size());
+
+	string path = BidSnapshot::PathFor(csvPath);
+	string tempPath = path + ".tmp";
+	{
+		ofstream out(tempPath, ios::binary | ios::trunc);
+		out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		out.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(BidSnapshotRecord));
+		out.write(heap.data(), heap.size());
+		out.write(padding.data(), padding.size());
+		if (!out) {
+			return false;
+		}
+	}
+
+	error_code error;
+	filesystem::rename(tempPath, path, error);
+	if (error) {
+		filesystem::remove(tempPath, error);
+		return false;
+	}
+	return true;
+}
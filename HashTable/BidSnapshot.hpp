@@ -0,0 +1,91 @@
+//============================================================================
+// Name        : BidSnapshot.hpp
+// Author      : Connor Sculthorpe
+// Version     : 1.0
+// Description : Binary snapshot of a parsed bid file, loaded instead of the
+//               CSV while the CSV is unchanged
+//============================================================================
+
+#ifndef BIDSNAPSHOT_HPP
+#define BIDSNAPSHOT_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "CSVparser.hpp"
+
+/*
+ * File layout, little endian, lives next to the CSV as <csv>.snap:
+ *   Header   fixed size, identifies the source file it was built from
+ *   Record   header.count fixed-width records
+ *   heap     header.heapSize bytes of string data the records point into
+ * The checksum covers the records and the heap.
+ */
+struct BidSnapshotHeader {
+	char magic[8]; // "BIDSNAP\0"
+	uint32_t version;
+	uint32_t count; // number of records
+	uint64_t sourceSize; // CSV size in bytes when the snapshot was written
+	int64_t sourceTime; // CSV last write time when the snapshot was written
+	uint64_t heapSize;
+	uint64_t checksum;
+};
+
+struct BidSnapshotRecord {
+	uint32_t bidId;
+	uint32_t titleOffset; // offsets and lengths into the heap
+	uint32_t titleLength;
+	uint32_t fundOffset;
+	uint32_t fundLength;
+	uint32_t reserved; // keeps amount 8-byte aligned, always 0
+	int64_t amount; // in cents
+};
+
+// The file is read in place, so the layout must not depend on the compiler
+static_assert(sizeof(BidSnapshotHeader) == 48, "snapshot header layout changed");
+static_assert(sizeof(BidSnapshotRecord) == 32, "snapshot record layout changed");
+
+/**
+ * Read side, the snapshot is memory mapped and read in place
+ */
+class BidSnapshot {
+
+private:
+	csv::MappedFile file;
+	const BidSnapshotRecord* records;
+	const char* heap;
+	uint32_t count;
+
+	std::string_view text(uint32_t offset, uint32_t length) const;
+
+public:
+	BidSnapshot();
+	bool Open(const std::string& csvPath);
+	size_t Size() const;
+	uint32_t BidId(size_t i) const;
+	std::string_view Title(size_t i) const;
+	std::string_view Fund(size_t i) const;
+	int64_t Amount(size_t i) const;
+
+	static std::string PathFor(const std::string& csvPath);
+};
+
+/**
+ * Write side, collects bids then writes them out in one go
+ */
+class BidSnapshotWriter {
+
+private:
+	std::vector<BidSnapshotRecord> records;
+	std::string heap;
+
+	uint32_t append(std::string_view text);
+
+public:
+	void Add(uint32_t bidId, std::string_view title, std::string_view fund, int64_t amount);
+	bool Write(const std::string& csvPath) const;
+};
+
+#endif // BIDSNAPSHOT_HPP
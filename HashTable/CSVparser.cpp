@@ -1,108 +1,447 @@
 #include <fstream>
 #include <sstream>
 #include <iomanip>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <exception>
+#include <thread>
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+# define CSV_X86
+# ifdef _MSC_VER
+#  include <intrin.h>
+#  define CSV_TARGET_SSE2
+#  define CSV_TARGET_AVX2
+# else
+#  include <immintrin.h>
+#  define CSV_TARGET_SSE2 __attribute__((target("sse2")))
+#  define CSV_TARGET_AVX2 __attribute__((target("avx2")))
+# endif
+#endif
+#ifdef _WIN32
+# define WIN32_LEAN_AND_MEAN
+# define NOMINMAX
+# include <windows.h>
+#else
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
 #include "CSVparser.hpp"
 
 namespace csv {
 
-  Parser::Parser(const std::string &data, const DataType &type, char sep)
-    : _type(type), _sep(sep)
+  /*
+  ** Next non-empty line of text starting at pos, without its line ending.
+  ** Returns false once the text is exhausted.
+  */
+  static bool nextLine(std::string_view text, std::size_t &pos, std::string_view &line)
   {
-      std::string line;
-      if (type == eFILE)
+      while (pos < text.size())
       {
-        _file = data;
-        std::ifstream ifile(_file.c_str());
-        if (ifile.is_open())
-        {
-            while (ifile.good())
-            {
-                getline(ifile, line);
-                if (line != "")
-                    _originalFile.push_back(line);
-            }
-            ifile.close();
-
-            if (_originalFile.size() == 0)
-              throw Error(std::string("No Data in ").append(_file));
-            
-            parseHeader();
-            parseContent();
-        }
-        else
-            throw Error(std::string("Failed to open ").append(_file));
+          std::size_t eol = text.find('\n', pos);
+          if (eol == std::string_view::npos)
+              eol = text.size();
+          line = text.substr(pos, eol - pos);
+          pos = eol + 1;
+          if (!line.empty() && line.back() == '\r')
+              line.remove_suffix(1);
+          if (!line.empty())
+              return true;
+      }
+      return false;
+  }
+
+  /*
+  ** SCANNING KERNELS
+  ** A line is scanned 64 bytes at a time. A kernel sets bit i of quotes/seps
+  ** when block[i] is '"' or the separator; SSE2 and AVX2 do 16 or 32 bytes per
+  ** compare, the scalar kernel is the fallback on other CPUs.
+  */
+  typedef void (*MaskKernel)(const char *block, char sep, std::uint64_t &quotes, std::uint64_t &seps);
+
+  static void masksScalar(const char *block, char sep, std::uint64_t &quotes, std::uint64_t &seps)
+  {
+      quotes = 0;
+      seps = 0;
+      for (unsigned int i = 0; i < 64; i++)
+      {
+          quotes |= static_cast<std::uint64_t>(block[i] == '"') << i;
+          seps |= static_cast<std::uint64_t>(block[i] == sep) << i;
+      }
+  }
+
+#ifdef CSV_X86
+  CSV_TARGET_SSE2
+  static void masksSSE2(const char *block, char sep, std::uint64_t &quotes, std::uint64_t &seps)
+  {
+      const __m128i quote = _mm_set1_epi8('"');
+      const __m128i separator = _mm_set1_epi8(sep);
+
+      quotes = 0;
+      seps = 0;
+      for (unsigned int i = 0; i < 4; i++)
+      {
+          __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + 16 * i));
+          quotes |= static_cast<std::uint64_t>(static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, quote)))) << (16 * i);
+          seps |= static_cast<std::uint64_t>(static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, separator)))) << (16 * i);
       }
+  }
+
+  CSV_TARGET_AVX2
+  static void masksAVX2(const char *block, char sep, std::uint64_t &quotes, std::uint64_t &seps)
+  {
+      const __m256i quote = _mm256_set1_epi8('"');
+      const __m256i separator = _mm256_set1_epi8(sep);
+      __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block));
+      __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block + 32));
+
+      quotes = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, quote)))
+          | (static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, quote)))) << 32);
+      seps = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, separator)))
+          | (static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, separator)))) << 32);
+  }
+
+  static bool cpuHasSSE2(void)
+  {
+# ifdef _MSC_VER
+      int info[4];
+      __cpuid(info, 1);
+      return (info[3] & (1 << 26)) != 0;
+# else
+      return __builtin_cpu_supports("sse2");
+# endif
+  }
+
+  static bool cpuHasAVX2(void)
+  {
+# ifdef _MSC_VER
+      int info[4];
+      __cpuid(info, 0);
+      if (info[0] < 7)
+          return false;
+      __cpuid(info, 1);
+      bool osxsave = (info[2] & (1 << 27)) != 0;
+      if (!osxsave || (_xgetbv(0) & 0x6) != 0x6) // OS saves the YMM registers
+          return false;
+      __cpuidex(info, 7, 0);
+      return (info[1] & (1 << 5)) != 0;
+# else
+      return __builtin_cpu_supports("avx2");
+# endif
+  }
+#endif
+
+  /*
+  ** Best kernel for this CPU, picked once at runtime.
+  */
+  static MaskKernel maskKernel(void)
+  {
+#ifdef CSV_X86
+      static const MaskKernel kernel = cpuHasAVX2() ? masksAVX2
+          : cpuHasSSE2() ? masksSSE2 : masksScalar;
+#else
+      static const MaskKernel kernel = masksScalar;
+#endif
+      return kernel;
+  }
+
+  static unsigned int lowestBit(std::uint64_t bits)
+  {
+#if defined(_MSC_VER) && defined(_M_X64)
+      unsigned long index;
+      _BitScanForward64(&index, bits);
+      return index;
+#elif defined(_MSC_VER)
+      unsigned long index;
+      if (_BitScanForward(&index, static_cast<unsigned long>(bits)))
+          return index;
+      _BitScanForward(&index, static_cast<unsigned long>(bits >> 32));
+      return index + 32;
+#else
+      return __builtin_ctzll(bits);
+#endif
+  }
+
+  /*
+  ** Bit i of the result is the parity of the quotes in bits [0, i],
+  ** i.e. set while inside a quoted field.
+  */
+  static std::uint64_t prefixXor(std::uint64_t bits)
+  {
+      bits ^= bits << 1;
+      bits ^= bits << 2;
+      bits ^= bits << 4;
+      bits ^= bits << 8;
+      bits ^= bits << 16;
+      bits ^= bits << 32;
+      return bits;
+  }
+
+  static void emitField(Row &row, const std::vector<int> &projection, std::size_t field, std::string_view value)
+  {
+      if (projection.empty())
+          row.pushView(value);
+      else if (field < projection.size() && projection[field] >= 0)
+          row.setView(projection[field], value);
+  }
+
+  /*
+  ** Split one record into fields on sep, quoted separators don't split.
+  ** Fields are views into line. With a projection, field i goes to slot
+  ** projection[i] of the row and fields mapped to -1 are skipped.
+  */
+  static void tokenize(std::string_view line, Row &row, std::size_t columns,
+                       const std::vector<int> &projection, char sep)
+  {
+      const MaskKernel masks = maskKernel();
+      std::uint64_t inside = 0; // all ones while a quote is open across blocks
+      std::size_t tokenStart = 0;
+      std::size_t field = 0;
+      char tail[64];
+
+      if (!projection.empty())
+          row.resize(row.header().size());
       else
+          row.reserve(columns);
+
+      for (std::size_t base = 0; base < line.length(); base += 64)
       {
-        std::istringstream stream(data);
-        while (std::getline(stream, line))
-          if (line != "")
-            _originalFile.push_back(line);
-        if (_originalFile.size() == 0)
-          throw Error(std::string("No Data in pure content"));
+          const char *block = line.data() + base;
+          if (line.length() - base < 64) // pad the last partial block
+          {
+              memset(tail, 0, sizeof(tail));
+              memcpy(tail, block, line.length() - base);
+              block = tail;
+          }
+
+          std::uint64_t quotes, seps;
+          masks(block, sep, quotes, seps);
+
+          std::uint64_t quoted = prefixXor(quotes) ^ inside;
+          inside = (quoted >> 63) ? ~static_cast<std::uint64_t>(0) : 0;
 
-        parseHeader();
-        parseContent();
+          for (seps &= ~quoted; seps != 0; seps &= seps - 1)
+          {
+              std::size_t i = base + lowestBit(seps);
+              emitField(row, projection, field++, line.substr(tokenStart, i - tokenStart));
+              tokenStart = i + 1;
+          }
       }
+
+      //end
+      emitField(row, projection, field++, line.substr(tokenStart));
+
+      // if value(s) missing
+      if (field != columns)
+        throw Error("corrupted data !");
+  }
+
+  /*
+  ** Header names, split on sep without quote handling.
+  */
+  static Header splitHeader(std::string_view line, char sep)
+  {
+      std::stringstream ss{std::string(line)};
+      std::string item;
+      std::vector<std::string> names;
+
+      while (std::getline(ss, item, sep))
+          names.push_back(item);
+      return Header(names);
+  }
+
+  /*
+  ** Header of the requested columns, and for every column of source the
+  ** slot it goes to (-1 when not requested). A requested column may list
+  ** alternative names as "a|b", the first one present in source is used.
+  */
+  static Header project(const Header &source, const std::vector<std::string> &columns,
+                        std::vector<int> &projection)
+  {
+      std::vector<std::string> names;
+
+      projection.assign(source.size(), -1);
+      for (unsigned int slot = 0; slot < columns.size(); slot++)
+      {
+          std::string_view alternatives = columns[slot];
+          int pos = -1;
+
+          while (pos < 0 && !alternatives.empty())
+          {
+              std::size_t bar = alternatives.find('|');
+              pos = source.indexOf(alternatives.substr(0, bar));
+              alternatives.remove_prefix(bar == std::string_view::npos ? alternatives.size() : bar + 1);
+          }
+          if (pos < 0)
+              throw Error(std::string("can't project this column (doesn't exist) : ").append(columns[slot]));
+          if (projection[pos] >= 0)
+              throw Error(std::string("column projected twice : ").append(columns[slot]));
+          projection[pos] = slot;
+          names.push_back(source[pos]);
+      }
+      return Header(names);
+  }
+
+  Parser::Parser(const std::string &data, const DataType &type, char sep, unsigned int threads)
+    : _type(type), _sep(sep), _threads(threads), _pos(0), _sourceColumns(0)
+  {
+      load(data);
+  }
+
+  Parser::Parser(const std::string &data, const std::vector<std::string> &columns,
+                 const DataType &type, char sep, unsigned int threads)
+    : _type(type), _sep(sep), _threads(threads), _pos(0), _sourceColumns(0), _columns(columns)
+  {
+      if (_columns.empty())
+        throw Error("can't project zero columns");
+      load(data);
   }
 
-  Parser::~Parser(void)
+  void Parser::load(const std::string &data)
   {
-     std::vector<Row *>::iterator it;
+      const DataType type = _type;
 
-     for (it = _content.begin(); it != _content.end(); it++)
-          delete *it;
+      if (type == eMAPPED)
+      {
+        _file = data;
+        _map.open(_file);
+        _text = std::string_view(_map.data(), _map.size());
+      }
+      else if (type == eFILE)
+      {
+        _file = data;
+        std::ifstream ifile(_file.c_str(), std::ios::binary);
+        if (!ifile.is_open())
+            throw Error(std::string("Failed to open ").append(_file));
+
+        ifile.seekg(0, std::ios::end);
+        _buffer.resize(static_cast<std::size_t>(ifile.tellg()));
+        ifile.seekg(0, std::ios::beg);
+        ifile.read(&_buffer[0], _buffer.size());
+        ifile.close();
+        _text = _buffer;
+      }
+      else
+      {
+        _buffer = data;
+        _text = _buffer;
+      }
+
+      std::string_view line;
+      std::size_t pos = 0;
+      if (!nextLine(_text, pos, line))
+      {
+        if (type == ePURE)
+          throw Error(std::string("No Data in pure content"));
+        throw Error(std::string("No Data in ").append(_file));
+      }
+
+      parseHeader();
+      parseContent();
   }
 
+  Parser::~Parser(void) {} // _arena releases every row at once
+
   void Parser::parseHeader(void)
   {
-      std::stringstream ss(_originalFile[0]);
-      std::string item;
+      std::string_view line;
+      nextLine(_text, _pos, line);
+      _header = splitHeader(line, _sep);
+      _sourceColumns = _header.size();
+      if (!_columns.empty())
+        _header = project(splitHeader(line, _sep), _columns, _projection);
+  }
+
+  /*
+  ** Parse every record of text into rows, in order.
+  */
+  void Parser::parseRange(std::string_view text, std::vector<Row> &rows, Arena &arena) const
+  {
+     std::string_view line;
+     std::size_t pos = 0;
 
-      while (std::getline(ss, item, _sep))
-          _header.push_back(item);
+     while (nextLine(text, pos, line))
+     {
+         rows.push_back(Row(_header, arena));
+         tokenize(line, rows.back(), _sourceColumns, _projection, _sep);
+     }
   }
 
   void Parser::parseContent(void)
   {
-     std::vector<std::string>::iterator it;
-     
-     it = _originalFile.begin();
-     it++; // skip header
+     // header already consumed by parseHeader
+     std::string_view body = _text.substr(_pos);
+     _pos = _text.size();
+
+     const std::size_t minChunk = 64 * 1024; // smaller chunks cost more to start than to parse
+     std::size_t chunks = _threads;
+     if (chunks == 0)
+       chunks = std::max(1u, std::thread::hardware_concurrency());
+     chunks = std::min(chunks, body.size() / minChunk + 1);
+
+     if (chunks <= 1)
+     {
+       parseRange(body, _content, _arena);
+       return;
+     }
 
-     for (; it != _originalFile.end(); it++)
+     // A record never spans lines (the tokenizer's quote state restarts on
+     // every line), so moving each cut to just past the next '\n' always lands
+     // on a record boundary, quoted fields like "$3,000 " included.
+     std::vector<std::size_t> cuts(chunks + 1, body.size());
+     cuts[0] = 0;
+     for (std::size_t i = 1; i < chunks; i++)
      {
-         bool quoted = false;
-         int tokenStart = 0;
-         unsigned int i = 0;
+       std::size_t eol = body.find('\n', std::max(cuts[i - 1], i * (body.size() / chunks)));
+       cuts[i] = (eol == std::string_view::npos) ? body.size() : eol + 1;
+     }
 
-         Row *row = new Row(_header);
+     std::vector<std::vector<Row> > parts(chunks);
+     std::vector<std::unique_ptr<Arena> > arenas; // an arena isn't shared between threads
+     for (std::size_t i = 0; i < chunks; i++)
+       arenas.emplace_back(new Arena());
+     std::vector<std::exception_ptr> errors(chunks);
+     std::vector<std::thread> workers;
 
-         for (; i != it->length(); i++)
+     for (std::size_t i = 0; i < chunks; i++)
+       workers.emplace_back([this, &body, &cuts, &parts, &arenas, &errors, i]()
+       {
+         try
+         {
+           parseRange(body.substr(cuts[i], cuts[i + 1] - cuts[i]), parts[i], *arenas[i]);
+         }
+         catch (...)
          {
-              if (it->at(i) == '"')
-                  quoted = ((quoted) ? (false) : (true));
-              else if (it->at(i) == ',' && !quoted)
-              {
-                  row->push(it->substr(tokenStart, i - tokenStart));
-                  tokenStart = i + 1;
-              }
+           errors[i] = std::current_exception();
          }
+       });
+     for (auto it = workers.begin(); it != workers.end(); it++)
+       it->join();
 
-         //end
-         row->push(it->substr(tokenStart, it->length() - tokenStart));
+     for (std::size_t i = 0; i < chunks; i++)
+       if (errors[i])
+         std::rethrow_exception(errors[i]);
 
-         // if value(s) missing
-         if (row->size() != _header.size())
-          throw Error("corrupted data !");
-         _content.push_back(row);
+     // stitch the chunks back together in file order
+     std::size_t total = 0;
+     for (auto part = parts.begin(); part != parts.end(); part++)
+       total += part->size();
+     _content.reserve(total);
+     for (std::size_t i = 0; i < chunks; i++)
+     {
+       _arena.merge(*arenas[i]);
+       for (auto row = parts[i].begin(); row != parts[i].end(); row++)
+         row->_arena = &_arena; // later push()/set() allocate from the parser's arena
+       _content.insert(_content.end(), parts[i].begin(), parts[i].end());
      }
   }
 
   Row &Parser::getRow(unsigned int rowPosition) const
   {
       if (rowPosition < _content.size())
-          return *(_content[rowPosition]);
+          return const_cast<Row &>(_content[rowPosition]); // rows have always been editable through here
       throw Error("can't return this row (doesn't exist)");
   }
 
@@ -123,7 +462,7 @@ namespace csv {
 
   std::vector<std::string> Parser::getHeader(void) const
   {
-      return _header;
+      return _header.names();
   }
 
   const std::string Parser::getHeaderElement(unsigned int pos) const
@@ -137,8 +476,7 @@ namespace csv {
   {
     if (pos < _content.size())
     {
-      delete *(_content.begin() + pos);
-      _content.erase(_content.begin() + pos);
+      _content.erase(_content.begin() + pos); // its memory goes back with the arena
       return true;
     }
     return false;
@@ -146,10 +484,10 @@ namespace csv {
 
   bool Parser::addRow(unsigned int pos, const std::vector<std::string> &r)
   {
-    Row *row = new Row(_header);
+    Row row(_header, _arena);
 
     for (auto it = r.begin(); it != r.end(); it++)
-      row->push(*it);
+      row.push(*it);
     
     if (pos <= _content.size())
     {
@@ -161,7 +499,7 @@ namespace csv {
 
   void Parser::sync(void) const
   {
-    if (_type == DataType::eFILE)
+    if (_type == DataType::eFILE && _columns.empty()) // a projection would drop the other columns
     {
       std::ofstream f;
       f.open(_file, std::ios::out | std::ios::trunc);
@@ -179,7 +517,7 @@ namespace csv {
       }
      
       for (auto it = _content.begin(); it != _content.end(); it++)
-        f << **it << std::endl;
+        f << *it << std::endl;
       f.close();
     }
   }
@@ -189,67 +527,291 @@ namespace csv {
       return _file;    
   }
   
+  /*
+  ** CONVERSIONS
+  */
+
+  static std::string_view trim(std::string_view text)
+  {
+      while (!text.empty() && (text.front() == ' ' || text.front() == '\t'))
+          text.remove_prefix(1);
+      while (!text.empty() && (text.back() == ' ' || text.back() == '\t'))
+          text.remove_suffix(1);
+      return text;
+  }
+
+  static bool fromChars(std::string_view text, long long &value)
+  {
+      const char *last = text.data() + text.size();
+      std::from_chars_result res = std::from_chars(text.data(), last, value);
+      return !text.empty() && res.ec == std::errc() && res.ptr == last;
+  }
+
+  static bool fromChars(std::string_view text, double &value)
+  {
+      const char *last = text.data() + text.size();
+      std::from_chars_result res = std::from_chars(text.data(), last, value);
+      return !text.empty() && res.ec == std::errc() && res.ptr == last;
+  }
+
+  bool parseInteger(std::string_view text, long long &value)
+  {
+      text = trim(text);
+      if (!text.empty() && text.front() == '+')
+          text.remove_prefix(1);
+      return fromChars(text, value);
+  }
+
+  bool parseDouble(std::string_view text, double &value)
+  {
+      text = trim(text);
+      if (!text.empty() && text.front() == '+')
+          text.remove_prefix(1);
+      return fromChars(text, value);
+  }
+
+  bool parseCurrency(std::string_view text, double &value)
+  {
+      char digits[64] = {}; // sign, digits and '.' only
+      std::size_t n = 0;
+
+      text = trim(text);
+      if (text.size() >= 2 && text.front() == '"' && text.back() == '"') // "$3,000 "
+          text = trim(text.substr(1, text.size() - 2));
+      for (std::size_t i = 0; i < text.size(); i++)
+      {
+          char c = text[i];
+          if (c == '$' || c == ',' || c == ' ')
+              continue;
+          if (n == sizeof(digits))
+              return false;
+          digits[n++] = c;
+      }
+      return fromChars(std::string_view(digits, n), value);
+  }
+
+  bool parsePercent(std::string_view text, double &value)
+  {
+      text = trim(text);
+      if (!text.empty() && text.back() == '%')
+      {
+          if (!fromChars(trim(text.substr(0, text.size() - 1)), value))
+              return false;
+          value /= 100.0;
+          return true;
+      }
+      return fromChars(text, value);
+  }
+
+  bool parseDate(std::string_view text, Date &value)
+  {
+      long long parts[3];
+
+      text = trim(text);
+      for (unsigned int i = 0; i < 3; i++)
+      {
+          std::size_t slash = (i < 2) ? text.find('/') : text.size();
+          if (slash == std::string_view::npos || !fromChars(text.substr(0, slash), parts[i]))
+              return false;
+          text.remove_prefix(std::min(slash + 1, text.size()));
+      }
+      if (parts[0] < 1 || parts[0] > 12 || parts[1] < 1 || parts[1] > 31)
+          return false;
+      value.month = static_cast<int>(parts[0]);
+      value.day = static_cast<int>(parts[1]);
+      value.year = static_cast<int>(parts[2]);
+      return true;
+  }
+
+  /*
+  ** HEADER
+  */
+
+  Header::Header(void) {}
+
+  Header::Header(const std::vector<std::string> &names)
+      : _names(names)
+  {
+      _keys.reserve(_names.size());
+      for (unsigned int i = 0; i < _names.size(); i++)
+          _keys.emplace_back(trim(_names[i]));
+  }
+
+  unsigned int Header::size(void) const
+  {
+      return _names.size();
+  }
+
+  int Header::indexOf(std::string_view name) const
+  {
+      name = trim(name);
+      for (unsigned int i = 0; i < _keys.size(); i++)
+          if (_keys[i] == name) // first column wins on duplicate names
+              return i;
+      return -1;
+  }
+
+  const std::string &Header::operator[](unsigned int pos) const
+  {
+      return _names[pos];
+  }
+
+  const std::vector<std::string> &Header::names(void) const
+  {
+      return _names;
+  }
+
+  std::vector<std::string>::const_iterator Header::begin(void) const
+  {
+      return _names.begin();
+  }
+
+  std::vector<std::string>::const_iterator Header::end(void) const
+  {
+      return _names.end();
+  }
+
   /*
   ** ROW
   */
 
-  Row::Row(const std::vector<std::string> &header)
-      : _header(header) {}
+  Row::Row(const Header &header, Arena &arena)
+      : _header(&header), _arena(&arena), _values(nullptr), _size(0), _capacity(0) {}
 
   Row::~Row(void) {}
 
   unsigned int Row::size(void) const
   {
-    return _values.size();
+    return _size;
   }
 
   void Row::push(const std::string &value)
   {
-    _values.push_back(value);
+    pushView(_arena->copy(value));
+  }
+
+  void Row::pushView(std::string_view value)
+  {
+    if (_size == _capacity)
+      reserve(_capacity < 8 ? 8 : _capacity * 2);
+    _values[_size++] = value;
+  }
+
+  void Row::setView(unsigned int pos, std::string_view value)
+  {
+    _values[pos] = value;
+  }
+
+  void Row::reserve(unsigned int capacity)
+  {
+    if (capacity <= _capacity)
+      return;
+    // the old array stays in the arena until it is released
+    std::string_view *values = static_cast<std::string_view *>(
+      _arena->allocate(capacity * sizeof(std::string_view), alignof(std::string_view)));
+    for (unsigned int i = 0; i < _size; i++)
+      values[i] = _values[i];
+    _values = values;
+    _capacity = capacity;
+  }
+
+  void Row::resize(unsigned int size)
+  {
+    reserve(size);
+    for (unsigned int i = _size; i < size; i++)
+      _values[i] = std::string_view();
+    _size = size;
+  }
+
+  const Header &Row::header(void) const
+  {
+    return *_header;
+  }
+
+  void Row::clear(void)
+  {
+    _values = nullptr; // the arena is about to be reset
+    _size = 0;
+    _capacity = 0;
   }
 
   bool Row::set(const std::string &key, const std::string &value) 
   {
-    std::vector<std::string>::const_iterator it;
-    int pos = 0;
+    int pos = _header->indexOf(key);
 
-    for (it = _header.begin(); it != _header.end(); it++)
-    {
-        if (key == *it)
-        {
-          _values[pos] = value;
-          return true;
-        }
-        pos++;
-    }
-    return false;
+    if (pos < 0 || static_cast<unsigned int>(pos) >= _size)
+      return false;
+    _values[pos] = _arena->copy(value);
+    return true;
   }
 
   const std::string Row::operator[](unsigned int valuePosition) const
   {
-       if (valuePosition < _values.size())
+       if (valuePosition < _size)
+           return std::string(_values[valuePosition]);
+       throw Error("can't return this value (doesn't exist)");
+  }
+
+  std::string_view Row::view(unsigned int valuePosition) const
+  {
+       if (valuePosition < _size)
            return _values[valuePosition];
        throw Error("can't return this value (doesn't exist)");
   }
 
   const std::string Row::operator[](const std::string &key) const
   {
-      std::vector<std::string>::const_iterator it;
-      int pos = 0;
+      int pos = _header->indexOf(key);
+
+      if (pos >= 0 && static_cast<unsigned int>(pos) < _size)
+          return std::string(_values[pos]);
 
-      for (it = _header.begin(); it != _header.end(); it++)
-      {
-          if (key == *it)
-              return _values[pos];
-          pos++;
-      }
-      
       throw Error("can't return this value (doesn't exist)");
   }
 
+  long long Row::getInteger(unsigned int pos) const
+  {
+      long long value;
+      if (!parseInteger(view(pos), value))
+          throw Error("can't convert this value to an integer");
+      return value;
+  }
+
+  double Row::getDouble(unsigned int pos) const
+  {
+      double value;
+      if (!parseDouble(view(pos), value))
+          throw Error("can't convert this value to a number");
+      return value;
+  }
+
+  double Row::getCurrency(unsigned int pos) const
+  {
+      double value;
+      if (!parseCurrency(view(pos), value))
+          throw Error("can't convert this value to an amount");
+      return value;
+  }
+
+  double Row::getPercent(unsigned int pos) const
+  {
+      double value;
+      if (!parsePercent(view(pos), value))
+          throw Error("can't convert this value to a percentage");
+      return value;
+  }
+
+  Date Row::getDate(unsigned int pos) const
+  {
+      Date value;
+      if (!parseDate(view(pos), value))
+          throw Error("can't convert this value to a date");
+      return value;
+  }
+
   std::ostream &operator<<(std::ostream &os, const Row &row)
   {
-      for (unsigned int i = 0; i != row._values.size(); i++)
+      for (unsigned int i = 0; i != row._size; i++)
           os << row._values[i] << " | ";
 
       return os;
@@ -257,12 +819,265 @@ namespace csv {
 
   std::ofstream &operator<<(std::ofstream &os, const Row &row)
   {
-    for (unsigned int i = 0; i != row._values.size(); i++)
+    for (unsigned int i = 0; i != row._size; i++)
     {
         os << row._values[i];
-        if (i < row._values.size() - 1)
+        if (i < row._size - 1)
           os << ",";
     }
     return os;
   }
+
+  /*
+  ** STREAM
+  */
+
+  Stream::Stream(const std::string &file, char sep, std::size_t blockSize)
+    : _file(file), _sep(sep), _block(blockSize > 0 ? blockSize : 1), _begin(0), _end(0), _sourceColumns(0)
+  {
+      open(std::vector<std::string>());
+  }
+
+  Stream::Stream(const std::string &file, const std::vector<std::string> &columns,
+                 char sep, std::size_t blockSize)
+    : _file(file), _sep(sep), _block(blockSize > 0 ? blockSize : 1), _begin(0), _end(0), _sourceColumns(0)
+  {
+      if (columns.empty())
+          throw Error("can't project zero columns");
+      open(columns);
+  }
+
+  void Stream::open(const std::vector<std::string> &columns)
+  {
+      _in.open(_file.c_str(), std::ios::binary);
+      if (!_in.is_open())
+          throw Error(std::string("Failed to open ").append(_file));
+
+      std::string_view line;
+      if (!readLine(line))
+          throw Error(std::string("No Data in ").append(_file));
+
+      _header = splitHeader(line, _sep);
+      _sourceColumns = _header.size();
+      if (!columns.empty())
+          _header = project(splitHeader(line, _sep), columns, _projection);
+      _row.reset(new Row(_header, _arena));
+  }
+
+  Stream::~Stream(void) {}
+
+  /*
+  ** Next non-empty line, refilling the block as needed. The view stays
+  ** valid until the following call.
+  */
+  bool Stream::readLine(std::string_view &line)
+  {
+      std::size_t scanned = _begin; // no '\n' in [_begin, scanned)
+
+      while (true)
+      {
+          const char *first = _block.data() + scanned;
+          const char *eol = static_cast<const char *>(memchr(first, '\n', _end - scanned));
+
+          if (eol != nullptr || (!_in.good() && _begin != _end))
+          {
+              std::size_t stop = (eol != nullptr) ? (eol - _block.data()) : _end;
+              line = std::string_view(_block.data() + _begin, stop - _begin);
+              _begin = (eol != nullptr) ? stop + 1 : stop;
+              scanned = _begin;
+              if (!line.empty() && line.back() == '\r')
+                  line.remove_suffix(1);
+              if (!line.empty())
+                  return true;
+              continue;
+          }
+          if (!_in.good())
+              return false;
+
+          // keep the partial line, make room after it and read the next block
+          std::size_t pending = _end - _begin;
+          if (_begin > 0)
+              memmove(_block.data(), _block.data() + _begin, pending);
+          if (pending == _block.size()) // line longer than a block
+              _block.resize(_block.size() * 2);
+          _begin = 0;
+          _end = pending;
+          scanned = pending;
+
+          _in.read(_block.data() + _end, _block.size() - _end);
+          _end += static_cast<std::size_t>(_in.gcount());
+      }
+  }
+
+  bool Stream::next(void)
+  {
+      std::string_view line;
+
+      _row->clear();
+      _arena.reset();
+      if (!readLine(line))
+          return false;
+      tokenize(line, *_row, _sourceColumns, _projection, _sep);
+      return true;
+  }
+
+  Stream::iterator Stream::begin(void)
+  {
+      return iterator(next() ? this : nullptr);
+  }
+
+  Stream::iterator Stream::end(void)
+  {
+      return iterator(nullptr);
+  }
+
+  Row &Stream::getRow(void) const
+  {
+      return *_row;
+  }
+
+  unsigned int Stream::columnCount(void) const
+  {
+      return _header.size();
+  }
+
+  std::vector<std::string> Stream::getHeader(void) const
+  {
+      return _header.names();
+  }
+
+  const std::string &Stream::getFileName(void) const
+  {
+      return _file;
+  }
+
+  Stream::iterator::iterator(Stream *stream)
+    : _stream(stream) {}
+
+  Row &Stream::iterator::operator*(void) const
+  {
+      return _stream->getRow();
+  }
+
+  Row *Stream::iterator::operator->(void) const
+  {
+      return &_stream->getRow();
+  }
+
+  Stream::iterator &Stream::iterator::operator++(void)
+  {
+      if (!_stream->next())
+          _stream = nullptr;
+      return *this;
+  }
+
+  bool Stream::iterator::operator!=(const iterator &other) const
+  {
+      return _stream != other._stream;
+  }
+
+  bool Stream::iterator::operator==(const iterator &other) const
+  {
+      return _stream == other._stream;
+  }
+
+  /*
+  ** MAPPED FILE
+  */
+
+#ifdef _WIN32
+  MappedFile::MappedFile(void)
+      : _data(nullptr), _size(0), _file(INVALID_HANDLE_VALUE), _mapping(nullptr) {}
+#else
+  MappedFile::MappedFile(void)
+      : _data(nullptr), _size(0), _fd(-1) {}
+#endif
+
+  MappedFile::~MappedFile(void)
+  {
+    close();
+  }
+
+  void MappedFile::open(const std::string &path)
+  {
+    close();
+#ifdef _WIN32
+    _file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                        OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (_file == INVALID_HANDLE_VALUE)
+      throw Error(std::string("Failed to open ").append(path));
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(_file, &size))
+    {
+      close();
+      throw Error(std::string("Failed to open ").append(path));
+    }
+    _size = static_cast<std::size_t>(size.QuadPart);
+    if (_size == 0) // an empty file can't be mapped, and holds no data anyway
+      return;
+
+    _mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (_mapping != nullptr)
+      _data = static_cast<const char *>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+    _fd = ::open(path.c_str(), O_RDONLY);
+    if (_fd < 0)
+      throw Error(std::string("Failed to open ").append(path));
+
+    struct stat st;
+    if (fstat(_fd, &st) != 0)
+    {
+      close();
+      throw Error(std::string("Failed to open ").append(path));
+    }
+    _size = static_cast<std::size_t>(st.st_size);
+    if (_size == 0) // an empty file can't be mapped, and holds no data anyway
+      return;
+
+    void *addr = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _fd, 0);
+    if (addr != MAP_FAILED)
+    {
+      madvise(addr, _size, MADV_SEQUENTIAL);
+      _data = static_cast<const char *>(addr);
+    }
+#endif
+    if (_data == nullptr)
+    {
+      close();
+      throw Error(std::string("Failed to map ").append(path));
+    }
+  }
+
+  void MappedFile::close(void)
+  {
+#ifdef _WIN32
+    if (_data != nullptr)
+      UnmapViewOfFile(_data);
+    if (_mapping != nullptr)
+      CloseHandle(_mapping);
+    if (_file != INVALID_HANDLE_VALUE)
+      CloseHandle(_file);
+    _mapping = nullptr;
+    _file = INVALID_HANDLE_VALUE;
+#else
+    if (_data != nullptr)
+      munmap(const_cast<char *>(_data), _size);
+    if (_fd >= 0)
+      ::close(_fd);
+    _fd = -1;
+#endif
+    _data = nullptr;
+    _size = 0;
+  }
+
+  const char *MappedFile::data(void) const
+  {
+    return _data;
+  }
+
+  std::size_t MappedFile::size(void) const
+  {
+    return _size;
+  }
 }
@@ -8,12 +8,35 @@
 //============================================================================
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <climits>
+#include <cmath>
+#include <cstring>
 #include <iostream>
-#include <string> // atoi
+#include <optional>
+#include <random>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
 #include <time.h>
+#include <type_traits>
+#include <unordered_map>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HASHTABLE_SSE2
+#include <emmintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
+#include "Bid.hpp"
+#include "BidSnapshot.hpp"
+#include "BloomFilter.hpp"
 #include "CSVparser.hpp"
+#include "NodePool.hpp"
+#include "PerfectHash.hpp"
 
 using namespace std;
 
@@ -22,191 +45,2034 @@ using namespace std;
 //============================================================================
 
 const unsigned int DEFAULT_SIZE = 179;
+const float DEFAULT_LOAD_FACTOR = 1.0f; // bids per bucket before the chained table grows
+const unsigned int REHASH_STEP = 4; // old buckets moved per operation while the chained table grows
+const unsigned int MIN_PENDING = 64; // new ids a PerfectHashTable holds aside before it builds its hash again
 
-// forward declarations
-double strToDouble(string str, char ch);
+/**
+ * Check a load factor before a chained table grows by it. At 0 or below,
+ * or NaN, the growth loops would never reach it.
+ *
+ * @param loadFactor Bids per bucket
+ * @return loadFactor, if it is a finite number above 0
+ */
+float checkedLoadFactor(float loadFactor) {
+	if (!isfinite(loadFactor) || loadFactor <= 0) {
+		throw invalid_argument("Load factor must be a number above 0");
+	}
+	return loadFactor;
+}
+
+//============================================================================
+// Hash policies
+//============================================================================
+
+/*
+ * A hash policy turns a bid id into a 64-bit hash (Hash) and reduces a hash
+ * to a bucket of a table of any size (Range). Tables whose size is a power of
+ * two mask the low bits of the hash instead of calling Range.
+ * The tables below use BidHash, pick another policy at compile time
+ * with e.g. /DBID_HASH=IdentityHash
+ */
+
+/**
+ * The original hashing: the id itself, reduced with %.
+ * Sequential ids spread evenly but ids a table size apart all collide.
+ */
+struct IdentityHash {
+	static uint64_t Hash(uint32_t key) {
+		return key;
+	}
+
+	static unsigned int Range(uint64_t hash, unsigned int size) {
+		return hash % size;
+	}
+};
+
+/**
+ * wyhash-style mixing over the bytes of the key. Every step is a
+ * 64 x 64 -> 128 bit multiply folded back to 64 bits, so each input bit
+ * reaches every output bit. Range uses the high half of the hash with a
+ * multiply and shift in place of a division.
+ */
+struct WyHash {
+	static uint64_t Hash(uint32_t key) {
+		return Bytes(&key, sizeof(key), 0);
+	}
+
+	static unsigned int Range(uint64_t hash, unsigned int size) {
+		return ((hash >> 32) * size) >> 32;
+	}
+
+	static uint64_t Bytes(const void* data, size_t length, uint64_t seed);
+
+private:
+	static void multiply(uint64_t& a, uint64_t& b);
+	static uint64_t mix(uint64_t a, uint64_t b);
+	static uint64_t read64(const uint8_t* p);
+	static uint64_t read32(const uint8_t* p);
+};
+
+const uint64_t WYHASH_SECRET[4] = { 0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL,
+	0x8ebc6af09c88c6e3ULL, 0x589965cc75374cc3ULL };
+
+/**
+ * Full 128-bit product of a and b, a gets the low half and b the high half
+ */
+void WyHash::multiply(uint64_t& a, uint64_t& b) {
+#if defined(__SIZEOF_INT128__)
+	unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+	a = static_cast<uint64_t>(product);
+	b = static_cast<uint64_t>(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+	a = _umul128(a, b, &b);
+#else // four 32 x 32 bit products
+	uint64_t aHigh = a >> 32, aLow = static_cast<uint32_t>(a);
+	uint64_t bHigh = b >> 32, bLow = static_cast<uint32_t>(b);
+	uint64_t highHigh = aHigh * bHigh, highLow = aHigh * bLow;
+	uint64_t lowHigh = aLow * bHigh, lowLow = aLow * bLow;
+	uint64_t middle = (lowLow >> 32) + static_cast<uint32_t>(highLow) + static_cast<uint32_t>(lowHigh);
+	a = (middle << 32) | static_cast<uint32_t>(lowLow);
+	b = highHigh + (highLow >> 32) + (lowHigh >> 32) + (middle >> 32);
+#endif
+}
+
+/**
+ * 128-bit product of a and b with the halves xored together
+ */
+uint64_t WyHash::mix(uint64_t a, uint64_t b) {
+	multiply(a, b);
+	return a ^ b;
+}
+
+uint64_t WyHash::read64(const uint8_t* p) {
+	uint64_t value;
+	memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+uint64_t WyHash::read32(const uint8_t* p) {
+	uint32_t value;
+	memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+/**
+ * Hash any run of bytes
+ *
+ * @param data The bytes to hash
+ * @param length Number of bytes
+ * @param seed Starting value, different seeds give unrelated hashes
+ * @return The 64-bit hash
+ */
+uint64_t WyHash::Bytes(const void* data, size_t length, uint64_t seed) {
+	const uint8_t* p = static_cast<const uint8_t*>(data);
+	seed ^= mix(seed ^ WYHASH_SECRET[0], WYHASH_SECRET[1]);
+
+	uint64_t a = 0;
+	uint64_t b = 0;
+	if (length <= 16) {
+		if (length >= 4) { // two overlapping reads from each end cover 4 to 16 bytes
+			size_t shift = (length >> 3) << 2;
+			a = (read32(p) << 32) | read32(p + shift);
+			b = (read32(p + length - 4) << 32) | read32(p + length - 4 - shift);
+		}
+		else if (length > 0) {
+			a = (uint64_t(p[0]) << 16) | (uint64_t(p[length >> 1]) << 8) | p[length - 1];
+		}
+	}
+	else {
+		size_t left = length;
+		while (left > 16) { // 16 bytes per step
+			seed = mix(read64(p) ^ WYHASH_SECRET[1], read64(p + 8) ^ seed);
+			p += 16;
+			left -= 16;
+		}
+		a = read64(p + left - 16); // the last 16 bytes, may overlap what was already mixed
+		b = read64(p + left - 8);
+	}
+
+	a ^= WYHASH_SECRET[1];
+	b ^= seed;
+	multiply(a, b);
+	return mix(a ^ WYHASH_SECRET[0] ^ length, b ^ WYHASH_SECRET[1]);
+}
+
+#ifndef BID_HASH
+#define BID_HASH WyHash
+#endif
+typedef BID_HASH BidHash;
+
+//============================================================================
+// Hash Table class definition
+//============================================================================
+
+/**
+ * Shape of a chained table at one moment, from HashTable::Stats().
+ * Probe counts are what a search would read given the layout, so they cost
+ * nothing on the search path.
+ */
+struct HashTableStats {
+	static const unsigned int HISTOGRAM_SIZE = 9; // 0 to 7, then 8 or more
+
+	unsigned int buckets = 0; // slots for the open addressing tables
+	unsigned int count = 0;
+	float loadFactor = 0;
+	bool openAddressing = false; // chainLengths counts probes, see below
+	unsigned int chainLengths[HISTOGRAM_SIZE] = {}; // buckets holding each number of bids; open addressing:
+	                                                // bids found after each number of probes, empty slots at 0
+	unsigned int maxProbe = 0; // bids, slots or groups read by the slowest search
+	double probesPerHit = 0; // read to find a stored bid, averaged over the bids
+	double probesPerMiss = 0; // read to rule out a missing one, averaged over where a search can start
+	unsigned int tombstones = 0; // slots a removal left marked deleted, only SwissHashTable has them
+	size_t bytes = 0; // the table's own memory, not the bid text
+
+	void Print() const;
+};
+
+/**
+ * Print the stats, the histogram on one line
+ */
+void HashTableStats::Print() const {
+	cout << "Hash table: " << count << " bids in " << buckets << (openAddressing ? " slots" : " buckets")
+		<< ", load factor " << loadFactor << endl;
+	cout << (openAddressing ? "  probe lengths:" : "  chain lengths:");
+	for (unsigned int length = 0; length < HISTOGRAM_SIZE; ++length) {
+		cout << " " << length << (length == HISTOGRAM_SIZE - 1 ? "+" : "") << ":" << chainLengths[length];
+	}
+	cout << endl;
+	cout << "  longest probe: " << maxProbe << ", probes per hit: " << probesPerHit
+		<< ", probes per miss: " << probesPerMiss << endl;
+	cout << "  tombstones: " << tombstones << ", memory: " << bytes << " bytes" << endl;
+}
+
+/**
+ * Define a class containing data members and methods to
+ * implement a hash table with chaining.
+ *
+ * The first bid of a bucket lives inline in nodes, the rest of its chain
+ * comes from a NodePool owned by the table.
+ */
+class HashTable {
+
+private:
+	// Define structures to hold bids
+	struct Node {
+		Bid bid;
+		unsigned int key;
+		Node* next;
+
+		// default constructor
+		Node() {
+			key = UINT_MAX; // 0xFFFFFFFF
+			next = nullptr;
+		}
+
+		// initialize with a bid
+		Node(Bid aBid) : Node() { // Calls the default constructor along with the new structure, minimalist design
+			bid = move(aBid);
+		}
+
+		// initialize with a bid and a key
+		Node(Bid aBid, unsigned int aKey) : Node(move(aBid)) { // Calls the bid constructor along with the new structure
+			key = aKey;
+		}
+	};
+
+	vector<Node> nodes;
+	vector<Node> oldNodes; // buckets still being moved into nodes after a grow, empty otherwise
+	NodePool<Node> pool; // every chain node of nodes and oldNodes
+
+	unsigned int tableSize = DEFAULT_SIZE;
+	unsigned int oldSize = 0;
+	unsigned int rehashIndex = 0; // oldNodes below this bucket have been moved
+	unsigned int count = 0;
+	float maxLoadFactor = DEFAULT_LOAD_FACTOR;
+
+	BloomFilter filter; // misses are usually answered here without touching a bucket
+	double filterRate = DEFAULT_FALSE_POSITIVE_RATE; // 0 turns the filter off
+
+	unsigned int hash(uint32_t key);
+	unsigned int oldHash(uint32_t key);
+	bool rehashing();
+	void grow();
+	void rehashStep();
+	void moveEntry(const Bid& bid, Node* node);
+	Node* findNode(Node* node, uint32_t bidId);
+	bool removeFrom(Node* head, uint32_t bidId);
+	void printChain(Node* node);
+	void addEntry(Bid&& bid, unsigned int key, NodePool<Node>& from);
+	void rebuildFilter(size_t expected);
+
+public:
+	HashTable();
+	HashTable(unsigned int size, float loadFactor = DEFAULT_LOAD_FACTOR);
+	virtual ~HashTable();
+	void Insert(Bid bid);
+	void BulkLoad(vector<Bid> bids, unsigned int threads = 0);
+	void PrintAll();
+	void Remove(uint32_t bidId);
+	void Remove(string_view bidId);
+	const Bid* Search(uint32_t bidId);
+	const Bid* Search(string_view bidId);
+	unsigned int Size();
+	float LoadFactor();
+	void SetMaxLoadFactor(float loadFactor);
+	void SetFilterRate(double falsePositiveRate);
+	const BloomFilter& Filter();
+	HashTableStats Stats() const;
+};
+
+/**
+ * Default constructor
+ */
+HashTable::HashTable() {
+	nodes.resize(tableSize); // Initalize node structure by resizing tableSize
+}
+
+/**
+ * Constructor for specifying size of the table
+ * Use to improve efficiency of hashing algorithm
+ * by reducing collisions without wasting memory.
+ */
+HashTable::HashTable(unsigned int size, float loadFactor) {
+	this->tableSize = size; // invoke local tableSize to size with this->
+	this->maxLoadFactor = checkedLoadFactor(loadFactor);
+	nodes.resize(tableSize); // resize nodes size
+}
+
+
+/**
+ * Destructor
+ * 
+ * The buckets free themselves and the pool gives back every chain node
+ * in one go, without walking the chains
+ */
+HashTable::~HashTable() {
+}
+
+/**
+ * Calculate the hash value of a given key.
+ * Note that key is specifically defined as
+ * unsigned int to prevent undefined results
+ * of a negative list index.
+ *
+ * @param key The key to hash
+ * @return The calculated hash
+ */
+unsigned int HashTable::hash(uint32_t key) {
+	return BidHash::Range(BidHash::Hash(key), tableSize);
+}
+
+/**
+ * Calculate the bucket of a key in the table being moved out of
+ *
+ * @param key The key to hash
+ * @return The calculated hash
+ */
+unsigned int HashTable::oldHash(uint32_t key) {
+	return BidHash::Range(BidHash::Hash(key), oldSize);
+}
+
+/**
+ * Whether a grow is still moving buckets over
+ */
+bool HashTable::rehashing() {
+	return !oldNodes.empty();
+}
+
+/**
+ * Start moving to a table about twice the size. Nothing is moved yet,
+ * each later operation moves a few buckets so no single insert stalls.
+ */
+void HashTable::grow() {
+	while (rehashing()) { // a grow still in progress is finished first
+		rehashStep();
+	}
+	oldNodes.swap(nodes);
+	oldSize = tableSize;
+	tableSize = tableSize * 2 + 1; // stay odd, 179 stays prime for several doublings in case the policy uses %
+	nodes.assign(tableSize, Node());
+	rehashIndex = 0;
+}
+
+/**
+ * Move the next REHASH_STEP buckets of the old table, then free it once it is empty
+ */
+void HashTable::rehashStep() {
+	for (unsigned int moved = 0; moved < REHASH_STEP && rehashIndex < oldNodes.size(); ++moved, ++rehashIndex) {
+		Node* head = &(oldNodes.at(rehashIndex));
+		Node* chain = head->next;
+		if (head->key != UINT_MAX) { // the inline head's bid is copied
+			moveEntry(head->bid, nullptr);
+		}
+		while (chain != nullptr) { // chain nodes are relinked
+			Node* next = chain->next;
+			moveEntry(chain->bid, chain);
+			chain = next;
+		}
+	}
+	if (rehashing() && rehashIndex >= oldNodes.size()) {
+		vector<Node>().swap(oldNodes); // by swapping with an empty vector, the old table's memory is given back
+		oldSize = 0;
+		rehashIndex = 0;
+	}
+}
+
+/**
+ * Put an entry of the old table into the current one
+ *
+ * @param bid The bid to move
+ * @param node The chain node holding it, reused if possible, nullptr for an inline head
+ */
+void HashTable::moveEntry(const Bid& bid, Node* node) {
+	unsigned int key = hash(bid.bidId);
+	Node* head = &(nodes.at(key));
+	if (head->key == UINT_MAX) { // unused bucket, the bid goes inline
+		head->key = key;
+		head->bid = bid;
+		if (node != nullptr) { // the chain node isn't needed any more
+			pool.Release(node);
+		}
+	}
+	else { // link in right after the head, no need to walk the chain
+		if (node == nullptr) {
+			node = pool.Allocate(bid, key);
+		}
+		node->key = key;
+		node->next = head->next;
+		head->next = node;
+	}
+}
+
+/**
+ * Find a bid along one bucket's chain
+ *
+ * @param node Head of the bucket
+ * @param bidId The bid id to search for
+ * @return The node holding the bid, nullptr if it isn't in this bucket
+ */
+HashTable::Node* HashTable::findNode(Node* node, uint32_t bidId) {
+	if (node->key == UINT_MAX) { // unused bucket
+		return nullptr;
+	}
+	while (node != nullptr) { // while node not equal to nullptr
+		if (node->key != UINT_MAX && node->bid.bidId == bidId) {// if the current node matches, return it
+			return node;
+		}
+		node = node->next; // node is equal to next node
+	}
+	return nullptr;
+}
+
+/**
+ * Insert a bid
+ *
+ * @param bid The bid to insert
+ */
+void HashTable::Insert(Bid bid) {
+	rehashStep();
+	if (count + 1 > maxLoadFactor * tableSize) { // past the load factor, start growing
+		grow();
+	}
+	++count;
+
+	unsigned key = hash(bid.bidId); // Bid ID is already numeric, call the hash for a key to have an index to the vector
+	uint32_t bidId = bid.bidId;
+	addEntry(move(bid), key, pool);
+
+	if (filterRate > 0) {
+		if (filter.Size() >= filter.Capacity()) { // full or never built, size it for twice what is here now
+			rebuildFilter(count * 2);
+		}
+		else {
+			filter.Add(bidId);
+		}
+	}
+}
+
+/**
+ * Put a bid at the end of its bucket
+ *
+ * @param bid The bid to add, moved from
+ * @param key Its bucket in nodes
+ * @param from Pool a chain node comes from
+ */
+void HashTable::addEntry(Bid&& bid, unsigned int key, NodePool<Node>& from) {
+	Node* node = &(nodes.at(key)); // Gets the address of the node at the key position
+	if (node->key == UINT_MAX) { // if node is not used
+		node->key = key; // assing old node key to UNIT_MAX, set to key, set old node to bid and old node next to null pointer
+		node->bid = move(bid);
+		node->next = nullptr;
+	}
+	else { // else find the next open node
+		while (node->next != nullptr) { // Iterates through, stops when the last node is reached (next is nullptr)
+			node = node->next; // Make the next node the "current" node
+		}
+		node->next = from.Allocate(move(bid), key); // add new newNode to end
+	}
+}
+
+/**
+ * Insert many bids at once. The table is sized for all of them up front,
+ * then the buckets are cut into one contiguous range per thread and each
+ * thread inserts only the bids that hash into its range, so no two threads
+ * ever touch the same bucket and no locks are needed. Bids go in bucket by
+ * bucket, so the chain nodes of a bucket are carved next to each other.
+ *
+ * @param bids The bids to insert, moved into the table
+ * @param threads Threads to insert with, 0 for one per core
+ */
+void HashTable::BulkLoad(vector<Bid> bids, unsigned int threads) {
+	while (rehashing()) { // a grow in progress is finished first
+		rehashStep();
+	}
+
+	// Size the table once for everything
+	unsigned int size = tableSize;
+	while (count + bids.size() > maxLoadFactor * size) {
+		size = size * 2 + 1;
+	}
+	if (size != tableSize) { // what is already here goes in front of the new bids and everything is laid out again
+		vector<Bid> all;
+		all.reserve(count + bids.size());
+		for (Node& head : nodes) {
+			if (head.key != UINT_MAX) {
+				all.push_back(move(head.bid));
+			}
+			for (Node* chain = head.next; chain != nullptr; chain = chain->next) {
+				all.push_back(move(chain->bid));
+			}
+		}
+		all.insert(all.end(), make_move_iterator(bids.begin()), make_move_iterator(bids.end()));
+		bids.swap(all);
+		tableSize = size;
+		nodes.assign(tableSize, Node());
+		pool.Clear(); // every chain node at once, its blocks are carved again below
+		count = 0;
+	}
+
+	if (threads == 0) {
+		threads = max(1u, thread::hardware_concurrency());
+	}
+	threads = min(threads, tableSize);
+	if (bids.size() < 4096) { // not worth starting threads
+		threads = 1;
+	}
+	auto inParallel = [threads](auto work) { // run work(0) .. work(threads - 1) and wait for all of them
+		vector<thread> pool;
+		for (unsigned int t = 1; t < threads; ++t) {
+			pool.emplace_back(work, t);
+		}
+		work(0);
+		for (thread& running : pool) {
+			running.join();
+		}
+	};
+
+	// Hash every bid once, each thread takes a slice
+	vector<unsigned int> keys(bids.size());
+	inParallel([&](unsigned int t) {
+		size_t end = bids.size() * (t + 1) / threads;
+		for (size_t i = bids.size() * t / threads; i < end; ++i) {
+			keys[i] = hash(bids[i].bidId);
+		}
+	});
+
+	// Order the bids by bucket, keeping input order within a bucket. The buckets
+	// of a thread are contiguous, so this also groups the bids by thread
+	auto owner = [&](unsigned int key) {
+		return static_cast<unsigned int>(uint64_t(key) * threads / tableSize);
+	};
+	vector<size_t> bucketStarts(tableSize + 1, 0);
+	vector<size_t> starts(threads + 1, 0);
+	for (unsigned int key : keys) {
+		++bucketStarts[key + 1];
+		++starts[owner(key) + 1];
+	}
+	for (unsigned int b = 0; b < tableSize; ++b) {
+		bucketStarts[b + 1] += bucketStarts[b];
+	}
+	for (unsigned int t = 0; t < threads; ++t) {
+		starts[t + 1] += starts[t];
+	}
+	vector<size_t> order(bids.size());
+	for (size_t i = 0; i < bids.size(); ++i) {
+		order[bucketStarts[keys[i]]++] = i;
+	}
+
+	// Each thread fills only its own buckets, with chain nodes from its own pool
+	vector<NodePool<Node>> threadPools(threads - 1); // thread 0 uses the table's
+	inParallel([&](unsigned int t) {
+		NodePool<Node>& from = t == 0 ? pool : threadPools[t - 1];
+		for (size_t i = starts[t]; i < starts[t + 1]; ++i) {
+			addEntry(move(bids[order[i]]), keys[order[i]], from);
+		}
+	});
+	for (NodePool<Node>& from : threadPools) {
+		pool.Merge(from);
+	}
+	count += static_cast<unsigned int>(bids.size());
+
+	if (filterRate > 0) {
+		rebuildFilter(count);
+	}
+}
+
+/**
+ * Size the Bloom filter and add every bid in the table to it
+ *
+ * @param expected Number of bids it should hold at filterRate
+ */
+void HashTable::rebuildFilter(size_t expected) {
+	filter.Build(max<size_t>(expected, count), filterRate);
+	for (unsigned int i = rehashIndex; i < oldNodes.size(); ++i) { // buckets not moved yet
+		if (oldNodes[i].key != UINT_MAX) {
+			for (Node* node = &oldNodes[i]; node != nullptr; node = node->next) {
+				filter.Add(node->bid.bidId);
+			}
+		}
+	}
+	for (Node& head : nodes) {
+		if (head.key != UINT_MAX) {
+			for (Node* node = &head; node != nullptr; node = node->next) {
+				filter.Add(node->bid.bidId);
+			}
+		}
+	}
+}
+
+/**
+ * Print one bucket, the head and every chain node after it
+ *
+ * @param node Head of the bucket
+ */
+void HashTable::printChain(Node* node) {
+	if (node->key == UINT_MAX) { // unused bucket
+		return;
+	}
+	for (Node* current = node; current != nullptr; current = current->next) { // node is equal to next iter
+		cout << current->key << current->bid.bidId << ": " << current->bid.Title()
+			<< " | " << current->bid.Dollars() << " | " << current->bid.Fund() << endl; // output key, bidID, title, amount and fund
+	}
+}
+
+/**
+ * Print all bids
+ */
+void HashTable::PrintAll() {
+	for (unsigned int i = rehashIndex; i < oldNodes.size(); ++i) { // buckets not moved yet
+		printChain(&(oldNodes.at(i)));
+	}
+	for (unsigned int i = 0; i < nodes.size(); ++i) { // for node begin to end iterate
+		printChain(&(nodes.at(i))); // Address of the first node passed to current
+	}
+	return;
+}
+
+/**
+ * Take a bid out of one bucket, the chain node it leaves goes back to the pool
+ *
+ * @param head Head of the bucket
+ * @param bidId The bid id to remove
+ * @return true if the bid was in this bucket
+ */
+bool HashTable::removeFrom(Node* head, uint32_t bidId) {
+	if (head->key == UINT_MAX) { // unused bucket
+		return false;
+	}
+	if (head->bid.bidId == bidId) {
+		Node* next = head->next;
+		if (next != nullptr) { // the first chain node moves up inline
+			head->bid = next->bid;
+			head->next = next->next;
+			pool.Release(next);
+		}
+		else {
+			*head = Node(); // unused again
+		}
+		return true;
+	}
+	for (Node* prev = head; prev->next != nullptr; prev = prev->next) {
+		if (prev->next->bid.bidId == bidId) { // unlink it, the rest of the chain stays put
+			Node* found = prev->next;
+			prev->next = found->next;
+			pool.Release(found);
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Remove a bid. Only its own bucket changes, so this is O(1) expected
+ * and every other bid stays where it is. Its bits stay in the Bloom
+ * filter until the filter is rebuilt.
+ *
+ * @param bidId The bid id to remove
+ */
+void HashTable::Remove(uint32_t bidId) {
+	rehashStep();
+
+	bool removed = false;
+	if (rehashing() && oldHash(bidId) >= rehashIndex) { // its old bucket hasn't been moved yet
+		removed = removeFrom(&(oldNodes.at(oldHash(bidId))), bidId);
+	}
+	if (!removed) {
+		removed = removeFrom(&(nodes.at(hash(bidId))), bidId);
+	}
+	if (removed) {
+		--count;
+	}
+}
+
+/**
+ * Search for the specified bidId
+ *
+ * @param bidId The bid id to search for
+ * @return The bid in the table, valid until the next call on the table, or nullptr
+ */
+const Bid* HashTable::Search(uint32_t bidId) {
+	rehashStep();
+
+	if (!filter.MayContain(bidId)) { // definitely not here, no bucket needs to be read
+		return nullptr;
+	}
+
+	Node* node = nullptr;
+	if (rehashing() && oldHash(bidId) >= rehashIndex) { // its old bucket hasn't been moved yet
+		node = findNode(&(oldNodes.at(oldHash(bidId))), bidId);
+	}
+	if (node == nullptr) {
+		node = findNode(&(nodes.at(hash(bidId))), bidId); // calculate and create the key for the given bid
+	}
+
+	if (node == nullptr) { // if no entry found for the key
+		if (filter.Enabled()) {
+			filter.RecordFalsePositive();
+		}
+		return nullptr; // no bid
+	}
+	return &(node->bid); // the node's bid, not a copy
+}
+
+/**
+ * Remove a bid by its Auction ID as text
+ */
+void HashTable::Remove(string_view bidId) {
+	uint32_t id;
+	if (ParseBidId(bidId, id)) {
+		Remove(id);
+	}
+}
+
+/**
+ * Search by the Auction ID as text, the text is parsed in place
+ */
+const Bid* HashTable::Search(string_view bidId) {
+	uint32_t id;
+	if (!ParseBidId(bidId, id)) { // not an Auction ID
+		return nullptr;
+	}
+	return Search(id);
+}
+
+/**
+ * Number of bids in the table
+ */
+unsigned int HashTable::Size() {
+	return count;
+}
+
+/**
+ * Bids per bucket
+ */
+float HashTable::LoadFactor() {
+	return float(count) / tableSize;
+}
+
+/**
+ * Set the load factor past which the table grows
+ *
+ * @param loadFactor Bids per bucket, above 0; anything else throws invalid_argument
+ */
+void HashTable::SetMaxLoadFactor(float loadFactor) {
+	maxLoadFactor = checkedLoadFactor(loadFactor);
+}
+
+/**
+ * Set the false positive rate of the Bloom filter in front of Search,
+ * the filter is rebuilt for it. 0 turns the filter off.
+ *
+ * @param falsePositiveRate Chance a missing bid still has its bucket searched
+ */
+void HashTable::SetFilterRate(double falsePositiveRate) {
+	filterRate = falsePositiveRate;
+	if (filterRate > 0) {
+		rebuildFilter(count);
+	}
+	else {
+		filter.Clear();
+	}
+}
+
+/**
+ * The Bloom filter, for its counters
+ */
+const BloomFilter& HashTable::Filter() {
+	return filter;
+}
+
+/**
+ * Measure the table: one pass over the buckets and chains, nothing is
+ * allocated or changed, so it is safe to call every so often on a live table.
+ * Buckets of a grow in progress that haven't moved yet are counted as they are.
+ */
+HashTableStats HashTable::Stats() const {
+	HashTableStats stats;
+	stats.count = count;
+	stats.loadFactor = count / float(tableSize);
+
+	double hitProbes = 0;
+	double missProbes = 0;
+	auto measure = [&](const Node& head) {
+		unsigned int length = 0;
+		if (head.key != UINT_MAX) {
+			for (const Node* node = &head; node != nullptr; node = node->next) {
+				++length;
+			}
+		}
+		++stats.buckets;
+		++stats.chainLengths[min(length, HashTableStats::HISTOGRAM_SIZE - 1)];
+		stats.maxProbe = max(stats.maxProbe, length);
+		hitProbes += length * (length + 1) / 2.0; // the i-th bid of a chain is found after i reads
+		missProbes += max(length, 1u); // a miss reads the whole chain, or just the unused head
+	};
+	for (unsigned int i = rehashIndex; i < oldNodes.size(); ++i) {
+		measure(oldNodes[i]);
+	}
+	for (const Node& head : nodes) {
+		measure(head);
+	}
+
+	stats.probesPerHit = count != 0 ? hitProbes / count : 0;
+	stats.probesPerMiss = stats.buckets != 0 ? missProbes / stats.buckets : 0;
+	stats.bytes = sizeof(HashTable) + (nodes.capacity() + oldNodes.capacity()) * sizeof(Node)
+		+ pool.Bytes() + filter.Bytes();
+	return stats;
+}
+
+//============================================================================
+// Robin Hood Hash Table class definition
+//============================================================================
+
+/**
+ * Define a class containing data members and methods to
+ * implement a hash table with open addressing and Robin Hood displacement.
+ *
+ * Slots live in flat parallel arrays: a probe reads only the one byte
+ * distance and the key of each slot, the Bid is touched once the key matches.
+ * An entry that has probed further than the one in the slot takes that slot,
+ * which keeps every probe sequence short. Removal shifts the following
+ * entries back instead of leaving a tombstone.
+ */
+class RobinHoodHashTable {
+
+private:
+	static const uint8_t MAX_DISTANCE = UINT8_MAX; // longest probe the distance byte can hold
+
+	vector<uint8_t> distances; // probe distance + 1 of the entry in each slot, 0 when the slot is empty
+	vector<uint32_t> keys; // bidId of each slot
+	vector<Bid> bids; // record of each slot
+
+	unsigned int mask; // slot count - 1, the slot count is a power of two
+	unsigned int count = 0;
+
+	unsigned int hash(uint32_t key);
+	void resize(unsigned int slots);
+	bool place(Bid& bid);
+	int find(uint32_t bidId);
+
+public:
+	RobinHoodHashTable();
+	RobinHoodHashTable(unsigned int size);
+	virtual ~RobinHoodHashTable();
+	void Insert(Bid bid);
+	void BulkLoad(vector<Bid> bids, unsigned int threads = 0);
+	void PrintAll();
+	void Remove(uint32_t bidId);
+	void Remove(string_view bidId);
+	const Bid* Search(uint32_t bidId);
+	const Bid* Search(string_view bidId);
+	unsigned int Size();
+	HashTableStats Stats() const;
+};
+
+/**
+ * Default constructor
+ */
+RobinHoodHashTable::RobinHoodHashTable() : RobinHoodHashTable(DEFAULT_SIZE) {
+}
+
+/**
+ * Constructor for specifying the expected number of bids,
+ * the table starts with room for them without growing.
+ */
+RobinHoodHashTable::RobinHoodHashTable(unsigned int size) {
+	unsigned int slots = 16;
+	while (slots / 8 * 7 < size) { // stay at or under a 7/8 load
+		slots *= 2;
+	}
+	resize(slots);
+}
+
+/**
+ * Destructor, the arrays free themselves
+ */
+RobinHoodHashTable::~RobinHoodHashTable() {
+}
+
+/**
+ * Calculate the home slot of a given key
+ *
+ * @param key The key to hash
+ * @return The calculated slot
+ */
+unsigned int RobinHoodHashTable::hash(uint32_t key) {
+	return BidHash::Hash(key) & mask;
+}
+
+/**
+ * Move every entry into a new set of arrays
+ *
+ * @param slots The new slot count, a power of two
+ */
+void RobinHoodHashTable::resize(unsigned int slots) {
+	vector<uint8_t> oldDistances(slots, 0);
+	vector<uint32_t> oldKeys(slots, 0);
+	vector<Bid> oldBids(slots);
+	oldDistances.swap(distances); // the new empty arrays are now the table
+	oldKeys.swap(keys);
+	oldBids.swap(bids);
+	mask = slots - 1;
+	count = 0;
+
+	for (unsigned int i = 0; i < oldDistances.size(); ++i) {
+		if (oldDistances[i] != 0) {
+			Insert(oldBids[i]);
+		}
+	}
+}
+
+/**
+ * Put a bid in its slot, displacing entries closer to home on the way.
+ * A bid with the same id is replaced.
+ *
+ * @param bid The bid to place, on failure it holds the entry that is left without a slot
+ * @return false if a probe got longer than a distance byte can hold
+ */
+bool RobinHoodHashTable::place(Bid& bid) {
+	unsigned int slot = hash(bid.bidId);
+	uint8_t distance = 1;
+	bool displaced = false; // once an entry moved the bid in hand is already unique
+
+	while (true) {
+		if (distances[slot] == 0) { // empty slot ends the probe
+			distances[slot] = distance;
+			keys[slot] = bid.bidId;
+			bids[slot] = bid;
+			++count;
+			return true;
+		}
+		if (!displaced && keys[slot] == bid.bidId) { // already here, replace it
+			bids[slot] = bid;
+			return true;
+		}
+		if (distances[slot] < distance) { // the resident is closer to home, take its slot
+			swap(distances[slot], distance);
+			swap(bids[slot], bid);
+			keys[slot] = bids[slot].bidId;
+			displaced = true;
+		}
+		slot = (slot + 1) & mask;
+		if (distance == MAX_DISTANCE) {
+			return false;
+		}
+		++distance;
+	}
+}
+
+/**
+ * Insert a bid, growing the table past a 7/8 load
+ *
+ * @param bid The bid to insert
+ */
+void RobinHoodHashTable::Insert(Bid bid) {
+	if (count + 1 > (mask + 1) / 8 * 7) {
+		resize((mask + 1) * 2);
+	}
+	while (!place(bid)) { // a probe overflowed, spread the entries out and place what is left over
+		resize((mask + 1) * 2);
+	}
+}
+
+/**
+ * Insert many bids at once, the table is sized for all of them first.
+ * Displacement moves entries across any range of slots, so this is
+ * single threaded; threads is only there to match the other tables.
+ *
+ * @param bids The bids to insert, moved into the table
+ */
+void RobinHoodHashTable::BulkLoad(vector<Bid> bids, unsigned int /*threads*/) {
+	unsigned int slots = mask + 1;
+	while (slots / 8 * 7 < count + bids.size()) {
+		slots *= 2;
+	}
+	if (slots != mask + 1) {
+		resize(slots);
+	}
+	for (Bid& bid : bids) {
+		Insert(move(bid));
+	}
+}
+
+/**
+ * Find the slot holding a bid
+ *
+ * @param bidId The bid id to search for
+ * @return The slot, or -1 if the bid is not in the table
+ */
+int RobinHoodHashTable::find(uint32_t bidId) {
+	unsigned int slot = hash(bidId);
+	unsigned int distance = 1;
+
+	// Entries along a probe are ordered by distance, a resident closer to home means the key isn't here
+	while (distances[slot] >= distance) {
+		if (keys[slot] == bidId) {
+			return slot;
+		}
+		slot = (slot + 1) & mask;
+		++distance;
+	}
+	return -1;
+}
+
+/**
+ * Print all bids
+ */
+void RobinHoodHashTable::PrintAll() {
+	for (unsigned int i = 0; i < distances.size(); ++i) {
+		if (distances[i] != 0) {
+			cout << bids[i].bidId << ": " << bids[i].Title() << " | " << bids[i].Dollars() << " | "
+				<< bids[i].Fund() << endl;
+		}
+	}
+}
+
+/**
+ * Remove a bid, the entries after it shift back one slot
+ * so no probe sequence is left with a gap
+ *
+ * @param bidId The bid id to remove
+ */
+void RobinHoodHashTable::Remove(uint32_t bidId) {
+	int found = find(bidId);
+	if (found < 0) {
+		return;
+	}
+
+	unsigned int slot = found;
+	unsigned int next = (slot + 1) & mask;
+	while (distances[next] > 1) { // stop at an empty slot or an entry already at home
+		distances[slot] = distances[next] - 1;
+		keys[slot] = keys[next];
+		bids[slot] = bids[next];
+		slot = next;
+		next = (next + 1) & mask;
+	}
+	distances[slot] = 0;
+	bids[slot] = Bid();
+	--count;
+}
+
+/**
+ * Search for the specified bidId
+ *
+ * @param bidId The bid id to search for
+ * @return The bid in the table, valid until the table is next changed, or nullptr
+ */
+const Bid* RobinHoodHashTable::Search(uint32_t bidId) {
+	int slot = find(bidId);
+	if (slot < 0) {
+		return nullptr;
+	}
+	return &bids[slot];
+}
+
+/**
+ * Remove a bid by its Auction ID as text
+ */
+void RobinHoodHashTable::Remove(string_view bidId) {
+	uint32_t id;
+	if (ParseBidId(bidId, id)) {
+		Remove(id);
+	}
+}
+
+/**
+ * Search by the Auction ID as text, the text is parsed in place
+ */
+const Bid* RobinHoodHashTable::Search(string_view bidId) {
+	uint32_t id;
+	if (!ParseBidId(bidId, id)) { // not an Auction ID
+		return nullptr;
+	}
+	return Search(id);
+}
+
+/**
+ * Number of bids in the table
+ */
+unsigned int RobinHoodHashTable::Size() {
+	return count;
+}
+
+/**
+ * Probe lengths of the table, a probe reads one slot. Removal shifts the
+ * following entries back, so there are never tombstones.
+ * Time: O(slots times the average probe)
+ */
+HashTableStats RobinHoodHashTable::Stats() const {
+	HashTableStats stats;
+	stats.openAddressing = true;
+	stats.buckets = static_cast<unsigned int>(distances.size());
+	stats.count = count;
+	stats.loadFactor = count / float(stats.buckets);
+
+	double hitProbes = 0;
+	double missProbes = 0;
+	for (unsigned int slot = 0; slot < distances.size(); ++slot) {
+		unsigned int probes = distances[slot]; // the slots read to find it, 0 for an empty slot
+		++stats.chainLengths[min(probes, HashTableStats::HISTOGRAM_SIZE - 1)];
+		stats.maxProbe = max(stats.maxProbe, probes);
+		hitProbes += probes;
+
+		unsigned int distance = 1; // a miss starting here stops at the first resident closer to home
+		for (unsigned int at = slot; distances[at] >= distance; at = (at + 1) & mask) {
+			++distance;
+		}
+		missProbes += distance;
+	}
+
+	stats.probesPerHit = count != 0 ? hitProbes / count : 0;
+	stats.probesPerMiss = stats.buckets != 0 ? missProbes / stats.buckets : 0;
+	stats.bytes = sizeof(RobinHoodHashTable) + distances.capacity() * sizeof(uint8_t)
+		+ keys.capacity() * sizeof(uint32_t) + bids.capacity() * sizeof(Bid);
+	return stats;
+}
+
+//============================================================================
+// Swiss Hash Table class definition
+//============================================================================
+
+/**
+ * Define a class containing data members and methods to
+ * implement a hash table probed 16 slots at a time.
+ *
+ * Every slot has a one byte control tag: empty, deleted, or 7 bits of the
+ * key's hash. A probe loads a group of 16 tags and compares them all at once
+ * with SSE2, so a Bid is only read when its tag matches.
+ */
+class SwissHashTable {
+
+private:
+	static constexpr unsigned int GROUP_WIDTH = 16;
+	static constexpr int8_t EMPTY = -128; // 0b10000000
+	static constexpr int8_t DELETED = -2; // 0b11111110, full tags are 0b0xxxxxxx
+
+	vector<int8_t> control; // tag of each slot, groups of GROUP_WIDTH
+	vector<Bid> bids; // record of each slot
+
+	unsigned int groupMask; // group count - 1, the group count is a power of two
+	unsigned int count = 0;
+	unsigned int deleted = 0; // tombstones, they count against the load until the next rehash
+
+	static uint32_t match(const int8_t* group, int8_t tag);
+	static uint32_t matchEmpty(const int8_t* group);
+	static uint32_t matchFree(const int8_t* group);
+	static unsigned int lowestBit(uint32_t bits);
+
+	void resize(unsigned int groups);
+	int find(uint32_t bidId);
+
+public:
+	SwissHashTable();
+	SwissHashTable(unsigned int size);
+	virtual ~SwissHashTable();
+	void Insert(Bid bid);
+	void BulkLoad(vector<Bid> bids, unsigned int threads = 0);
+	void PrintAll();
+	void Remove(uint32_t bidId);
+	void Remove(string_view bidId);
+	const Bid* Search(uint32_t bidId);
+	const Bid* Search(string_view bidId);
+	unsigned int Size();
+	HashTableStats Stats() const;
+};
+
+/**
+ * Default constructor
+ */
+SwissHashTable::SwissHashTable() : SwissHashTable(DEFAULT_SIZE) {
+}
+
+/**
+ * Constructor for specifying the expected number of bids,
+ * the table starts with room for them without growing.
+ */
+SwissHashTable::SwissHashTable(unsigned int size) {
+	unsigned int groups = 1;
+	while (groups * GROUP_WIDTH / 8 * 7 < size) { // stay at or under a 7/8 load
+		groups *= 2;
+	}
+	resize(groups);
+}
+
+/**
+ * Destructor, the arrays free themselves
+ */
+SwissHashTable::~SwissHashTable() {
+}
+
+#ifdef HASHTABLE_SSE2
+
+/**
+ * Bit i is set when tag i of the group equals tag
+ */
+uint32_t SwissHashTable::match(const int8_t* group, int8_t tag) {
+	__m128i tags = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(tags, _mm_set1_epi8(tag)));
+}
+
+/**
+ * Bit i is set when slot i of the group is empty
+ */
+uint32_t SwissHashTable::matchEmpty(const int8_t* group) {
+	return match(group, EMPTY);
+}
+
+/**
+ * Bit i is set when slot i of the group is empty or deleted,
+ * those are the only tags with the high bit set
+ */
+uint32_t SwissHashTable::matchFree(const int8_t* group) {
+	__m128i tags = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+	return _mm_movemask_epi8(tags);
+}
+
+#else // one byte at a time where SSE2 isn't available
+
+uint32_t SwissHashTable::match(const int8_t* group, int8_t tag) {
+	uint32_t bits = 0;
+	for (unsigned int i = 0; i < GROUP_WIDTH; ++i) {
+		bits |= uint32_t(group[i] == tag) << i;
+	}
+	return bits;
+}
+
+uint32_t SwissHashTable::matchEmpty(const int8_t* group) {
+	return match(group, EMPTY);
+}
+
+uint32_t SwissHashTable::matchFree(const int8_t* group) {
+	uint32_t bits = 0;
+	for (unsigned int i = 0; i < GROUP_WIDTH; ++i) {
+		bits |= uint32_t(group[i] < 0) << i;
+	}
+	return bits;
+}
+
+#endif
+
+/**
+ * Index of the lowest set bit, bits must not be 0
+ */
+unsigned int SwissHashTable::lowestBit(uint32_t bits) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, bits);
+	return index;
+#else
+	return __builtin_ctz(bits);
+#endif
+}
+
+/**
+ * Move every bid into a new set of arrays, tombstones are dropped
+ *
+ * @param groups The new group count, a power of two
+ */
+void SwissHashTable::resize(unsigned int groups) {
+	vector<int8_t> oldControl(groups * GROUP_WIDTH, EMPTY);
+	vector<Bid> oldBids(groups * GROUP_WIDTH);
+	oldControl.swap(control); // the new empty arrays are now the table
+	oldBids.swap(bids);
+	groupMask = groups - 1;
+	count = 0;
+	deleted = 0;
+
+	for (unsigned int i = 0; i < oldControl.size(); ++i) {
+		if (oldControl[i] >= 0) {
+			Insert(oldBids[i]);
+		}
+	}
+}
+
+/**
+ * Find the slot holding a bid. Groups are probed in triangular
+ * order, which visits every group once because the count is a power of two.
+ *
+ * @param bidId The bid id to search for
+ * @return The slot, or -1 if the bid is not in the table
+ */
+int SwissHashTable::find(uint32_t bidId) {
+	uint64_t hash = BidHash::Hash(bidId); // the low 7 bits become the tag, the rest picks the first group
+	int8_t tag = hash & 0x7F;
+	unsigned int group = (hash >> 7) & groupMask;
+
+	for (unsigned int step = 1; step <= groupMask + 1; ++step) {
+		const int8_t* tags = &control[group * GROUP_WIDTH];
+		for (uint32_t bits = match(tags, tag); bits != 0; bits &= bits - 1) { // only tag matches are compared
+			unsigned int slot = group * GROUP_WIDTH + lowestBit(bits);
+			if (bids[slot].bidId == bidId) {
+				return slot;
+			}
+		}
+		if (matchEmpty(tags) != 0) { // an insert would have stopped here, the key isn't further along
+			return -1;
+		}
+		group = (group + step) & groupMask;
+	}
+	return -1;
+}
+
+/**
+ * Insert a bid, a bid with the same id is replaced
+ *
+ * @param bid The bid to insert
+ */
+void SwissHashTable::Insert(Bid bid) {
+	int found = find(bid.bidId);
+	if (found >= 0) {
+		bids[found] = bid;
+		return;
+	}
+
+	unsigned int groups = groupMask + 1;
+	if (count + deleted + 1 > groups * GROUP_WIDTH / 8 * 7) { // past a 7/8 load, tombstones included
+		resize(count + 1 > groups * GROUP_WIDTH / 2 ? groups * 2 : groups); // mostly tombstones, clean up in place
+	}
+
+	uint64_t hash = BidHash::Hash(bid.bidId);
+	unsigned int group = (hash >> 7) & groupMask;
+	for (unsigned int step = 1; ; ++step) { // the load limit guarantees a free slot
+		uint32_t bits = matchFree(&control[group * GROUP_WIDTH]);
+		if (bits != 0) {
+			unsigned int slot = group * GROUP_WIDTH + lowestBit(bits);
+			if (control[slot] == DELETED) {
+				--deleted;
+			}
+			control[slot] = hash & 0x7F;
+			bids[slot] = bid;
+			++count;
+			return;
+		}
+		group = (group + step) & groupMask;
+	}
+}
+
+/**
+ * Insert many bids at once, the table is sized for all of them first.
+ * A probe may run into any group, so this is single threaded;
+ * threads is only there to match the other tables.
+ *
+ * @param bids The bids to insert, moved into the table
+ */
+void SwissHashTable::BulkLoad(vector<Bid> bids, unsigned int /*threads*/) {
+	unsigned int groups = groupMask + 1;
+	while (groups * GROUP_WIDTH / 8 * 7 < count + deleted + bids.size()) {
+		groups *= 2;
+	}
+	if (groups != groupMask + 1) {
+		resize(groups);
+	}
+	for (Bid& bid : bids) {
+		Insert(move(bid));
+	}
+}
+
+/**
+ * Print all bids
+ */
+void SwissHashTable::PrintAll() {
+	for (unsigned int i = 0; i < control.size(); ++i) {
+		if (control[i] >= 0) {
+			cout << bids[i].bidId << ": " << bids[i].Title() << " | " << bids[i].Dollars() << " | "
+				<< bids[i].Fund() << endl;
+		}
+	}
+}
+
+/**
+ * Remove a bid. A group with an empty slot never sent a probe on to the
+ * next group, so the slot can go back to empty; otherwise it becomes a tombstone.
+ * Once a quarter of the slots are tombstones the table is rehashed in place.
+ *
+ * @param bidId The bid id to remove
+ */
+void SwissHashTable::Remove(uint32_t bidId) {
+	int slot = find(bidId);
+	if (slot < 0) {
+		return;
+	}
+	if (matchEmpty(&control[slot / GROUP_WIDTH * GROUP_WIDTH]) != 0) {
+		control[slot] = EMPTY;
+	}
+	else {
+		control[slot] = DELETED;
+		++deleted;
+	}
+	bids[slot] = Bid();
+	--count;
+
+	// After a mass removal the tombstones would lengthen every probe until the next grow
+	if (deleted > control.size() / 4) {
+		resize(groupMask + 1);
+	}
+}
+
+/**
+ * Search for the specified bidId
+ *
+ * @param bidId The bid id to search for
+ * @return The bid in the table, valid until the table is next changed, or nullptr
+ */
+const Bid* SwissHashTable::Search(uint32_t bidId) {
+	int slot = find(bidId);
+	if (slot < 0) {
+		return nullptr;
+	}
+	return &bids[slot];
+}
+
+/**
+ * Remove a bid by its Auction ID as text
+ */
+void SwissHashTable::Remove(string_view bidId) {
+	uint32_t id;
+	if (ParseBidId(bidId, id)) {
+		Remove(id);
+	}
+}
+
+/**
+ * Search by the Auction ID as text, the text is parsed in place
+ */
+const Bid* SwissHashTable::Search(string_view bidId) {
+	uint32_t id;
+	if (!ParseBidId(bidId, id)) { // not an Auction ID
+		return nullptr;
+	}
+	return Search(id);
+}
+
+/**
+ * Number of bids in the table
+ */
+unsigned int SwissHashTable::Size() {
+	return count;
+}
+
+/**
+ * Probe lengths of the table, a probe reads one group of GROUP_WIDTH tags.
+ * Every bid's probe is walked again from its first group.
+ * Time: O(slots times the average probe)
+ */
+HashTableStats SwissHashTable::Stats() const {
+	HashTableStats stats;
+	stats.openAddressing = true;
+	stats.buckets = static_cast<unsigned int>(control.size());
+	stats.count = count;
+	stats.loadFactor = count / float(stats.buckets);
+	stats.tombstones = deleted;
+
+	double hitProbes = 0;
+	for (unsigned int slot = 0; slot < control.size(); ++slot) {
+		unsigned int probes = 0; // free slots go at 0
+		if (control[slot] >= 0) {
+			unsigned int group = (BidHash::Hash(bids[slot].bidId) >> 7) & groupMask;
+			for (probes = 1; group != slot / GROUP_WIDTH; ++probes) {
+				group = (group + probes) & groupMask; // the same triangular order as find()
+			}
+		}
+		++stats.chainLengths[min(probes, HashTableStats::HISTOGRAM_SIZE - 1)];
+		stats.maxProbe = max(stats.maxProbe, probes);
+		hitProbes += probes;
+	}
+
+	double missProbes = 0;
+	for (unsigned int first = 0; first <= groupMask; ++first) { // a miss stops at the first group with an empty slot
+		unsigned int group = first;
+		unsigned int probes = 1;
+		while (probes <= groupMask && matchEmpty(&control[group * GROUP_WIDTH]) == 0) {
+			group = (group + probes) & groupMask;
+			++probes;
+		}
+		missProbes += probes;
+	}
+
+	stats.probesPerHit = count != 0 ? hitProbes / count : 0;
+	stats.probesPerMiss = missProbes / (groupMask + 1);
+	stats.bytes = sizeof(SwissHashTable) + control.capacity() * sizeof(int8_t) + bids.capacity() * sizeof(Bid);
+	return stats;
+}
+
+//============================================================================
+// Concurrent Hash Table class definition
+//============================================================================
+
+/**
+ * Define a class containing data members and methods to
+ * implement a hash table many threads can read and write at once.
+ *
+ * Buckets are spread over a fixed set of lock stripes: bucket i is guarded
+ * by the reader/writer lock of stripe i % STRIPES. Searches share a stripe,
+ * inserts and removes hold it alone, and threads working on different
+ * stripes never wait on each other. Only growing takes every stripe.
+ */
+class ConcurrentHashTable {
+
+private:
+	static constexpr unsigned int STRIPES = 64; // a power of two, buckets are always a multiple of it
+
+	struct alignas(64) Stripe { // each lock on its own cache line so stripes don't contend through it
+		shared_mutex lock;
+	};
+
+	Stripe stripes[STRIPES];
+	vector<vector<Bid>> buckets; // a bucket's bids sit next to each other, no chain to chase
+	atomic<unsigned int> bucketCount; // buckets.size() for readers that hold no stripe
+	atomic<unsigned int> count;
+	float maxLoadFactor;
+
+	void grow(unsigned int seen);
+
+public:
+	ConcurrentHashTable();
+	ConcurrentHashTable(unsigned int size, float loadFactor = DEFAULT_LOAD_FACTOR);
+	virtual ~ConcurrentHashTable();
+	void Insert(Bid bid);
+	void BulkLoad(vector<Bid> bids, unsigned int threads = 0);
+	void PrintAll();
+	void Remove(uint32_t bidId);
+	void Remove(string_view bidId);
+	optional<Bid> Search(uint32_t bidId);
+	optional<Bid> Search(string_view bidId);
+	unsigned int Size();
+};
+
+/**
+ * Default constructor
+ */
+ConcurrentHashTable::ConcurrentHashTable() : ConcurrentHashTable(DEFAULT_SIZE) {
+}
 
-// define a structure to hold bid information
-struct Bid {
-	string bidId; // unique identifier
-	string title;
-	string fund;
-	double amount;
-	Bid() {
-		amount = 0.0;
+/**
+ * Constructor for specifying the starting number of buckets,
+ * rounded up to a power of two of at least STRIPES
+ */
+ConcurrentHashTable::ConcurrentHashTable(unsigned int size, float loadFactor) : bucketCount(0), count(0) {
+	unsigned int slots = STRIPES;
+	while (slots < size) {
+		slots *= 2;
 	}
-};
+	buckets.resize(slots);
+	bucketCount = slots;
+	maxLoadFactor = checkedLoadFactor(loadFactor);
+}
 
-//============================================================================
-// Hash Table class definition
-//============================================================================
+/**
+ * Destructor, the buckets free themselves
+ */
+ConcurrentHashTable::~ConcurrentHashTable() {
+}
 
 /**
- * Define a class containing data members and methods to
- * implement a hash table with chaining.
+ * Double the buckets. Every stripe is locked in order, so no other
+ * operation is running while bids move.
+ *
+ * @param seen Bucket count the caller saw, nothing is done if another thread grew the table since
  */
-class HashTable {
+void ConcurrentHashTable::grow(unsigned int seen) {
+	vector<unique_lock<shared_mutex>> locks;
+	locks.reserve(STRIPES);
+	for (unsigned int i = 0; i < STRIPES; ++i) { // always the same order, two growers can't deadlock
+		locks.emplace_back(stripes[i].lock);
+	}
+	if (buckets.size() != seen) {
+		return;
+	}
 
-private:
-	// Define structures to hold bids
-	struct Node {
-		Bid bid;
-		unsigned int key;
-		Node* next;
+	vector<vector<Bid>> grown(buckets.size() * 2);
+	for (vector<Bid>& bucket : buckets) {
+		for (Bid& bid : bucket) {
+			grown[BidHash::Hash(bid.bidId) & (grown.size() - 1)].push_back(bid);
+		}
+	}
+	buckets.swap(grown);
+	bucketCount = static_cast<unsigned int>(buckets.size());
+}
 
-		// default constructor
-		Node() {
-			key = UINT_MAX; // 0xFFFFFFFF
-			next = nullptr;
+/**
+ * Insert a bid, a bid with the same id is replaced
+ *
+ * @param bid The bid to insert
+ */
+void ConcurrentHashTable::Insert(Bid bid) {
+	uint64_t hash = BidHash::Hash(bid.bidId);
+	{
+		unique_lock<shared_mutex> lock(stripes[hash & (STRIPES - 1)].lock);
+		vector<Bid>& bucket = buckets[hash & (buckets.size() - 1)]; // the size only changes under every stripe
+		for (Bid& held : bucket) {
+			if (held.bidId == bid.bidId) {
+				held = move(bid);
+				return;
+			}
 		}
+		bucket.push_back(move(bid));
+	}
 
-		// initialize with a bid
-		Node(Bid aBid) : Node() { // Calls the default constructor along with the new structure, minimalist design
-			bid = aBid;
+	unsigned int seen = bucketCount;
+	if (++count > maxLoadFactor * seen) {
+		grow(seen);
+	}
+}
+
+/**
+ * Insert many bids at once. The buckets are grown for all of them first,
+ * then each thread inserts a slice through the normal striped Insert.
+ *
+ * @param bids The bids to insert, moved into the table
+ * @param threads Threads to insert with, 0 for one per core
+ */
+void ConcurrentHashTable::BulkLoad(vector<Bid> bids, unsigned int threads) {
+	while (maxLoadFactor * bucketCount < count + bids.size()) {
+		grow(bucketCount);
+	}
+
+	if (threads == 0) {
+		threads = max(1u, thread::hardware_concurrency());
+	}
+	vector<thread> pool;
+	for (unsigned int t = 0; t < threads; ++t) {
+		pool.emplace_back([&, t]() {
+			size_t end = bids.size() * (t + 1) / threads;
+			for (size_t i = bids.size() * t / threads; i < end; ++i) {
+				Insert(move(bids[i]));
+			}
+		});
+	}
+	for (thread& running : pool) {
+		running.join();
+	}
+}
+
+/**
+ * Print all bids, writers wait until it is done
+ */
+void ConcurrentHashTable::PrintAll() {
+	vector<shared_lock<shared_mutex>> locks;
+	locks.reserve(STRIPES);
+	for (unsigned int i = 0; i < STRIPES; ++i) {
+		locks.emplace_back(stripes[i].lock);
+	}
+	for (vector<Bid>& bucket : buckets) {
+		for (Bid& bid : bucket) {
+			cout << bid.bidId << ": " << bid.Title() << " | " << bid.Dollars() << " | "
+				<< bid.Fund() << endl;
 		}
+	}
+}
 
-		// initialize with a bid and a key
-		Node(Bid aBid, unsigned int aKey) : Node(aBid) { // Calls the bid constructor along with the new structure
-			key = aKey;
+/**
+ * Remove a bid, the last bid of its bucket takes its place
+ *
+ * @param bidId The bid id to remove
+ */
+void ConcurrentHashTable::Remove(uint32_t bidId) {
+	uint64_t hash = BidHash::Hash(bidId);
+	unique_lock<shared_mutex> lock(stripes[hash & (STRIPES - 1)].lock);
+	vector<Bid>& bucket = buckets[hash & (buckets.size() - 1)];
+	for (Bid& held : bucket) {
+		if (held.bidId == bidId) {
+			held = bucket.back();
+			bucket.pop_back();
+			--count;
+			return;
 		}
-	};
+	}
+}
 
-	vector<Node> nodes;
+/**
+ * Search for the specified bidId, other searches on the same stripe run alongside
+ *
+ * @param bidId The bid id to search for
+ * @return A copy of the bid, or nothing. Other threads may move the stored
+ *         bid as soon as the stripe is unlocked, so no pointer is handed out
+ */
+optional<Bid> ConcurrentHashTable::Search(uint32_t bidId) {
+	uint64_t hash = BidHash::Hash(bidId);
+	shared_lock<shared_mutex> lock(stripes[hash & (STRIPES - 1)].lock);
+	for (const Bid& held : buckets[hash & (buckets.size() - 1)]) {
+		if (held.bidId == bidId) {
+			return held;
+		}
+	}
+	return nullopt;
+}
 
-	unsigned int tableSize = DEFAULT_SIZE;
+/**
+ * Remove a bid by its Auction ID as text
+ */
+void ConcurrentHashTable::Remove(string_view bidId) {
+	uint32_t id;
+	if (ParseBidId(bidId, id)) {
+		Remove(id);
+	}
+}
+
+/**
+ * Search by the Auction ID as text, the text is parsed in place
+ */
+optional<Bid> ConcurrentHashTable::Search(string_view bidId) {
+	uint32_t id;
+	if (!ParseBidId(bidId, id)) { // not an Auction ID
+		return nullopt;
+	}
+	return Search(id);
+}
+
+/**
+ * Number of bids in the table
+ */
+unsigned int ConcurrentHashTable::Size() {
+	return count;
+}
+
+//============================================================================
+// Perfect Hash Table class definition
+//============================================================================
+
+/**
+ * Define a class containing data members and methods to
+ * implement a hash table over a minimal perfect hash.
+ *
+ * Every bid id the hash was built for owns exactly one slot, so Search is a
+ * single probe with no chains and no collisions. It is meant for a bid file
+ * that is loaded once and then only read. Insert of an id the hash wasn't
+ * built for parks the bid in a small map; the hash is only built again, in
+ * O(n), once that map holds an eighth of the table, so an insert is O(1)
+ * amortized. The hash is saved next to the bid file and reused by the next
+ * load as long as it still fits the ids.
+ */
+class PerfectHashTable {
 
-	unsigned int hash(int key);
+private:
+	PerfectHash index;
+	vector<uint32_t> keys; // id each slot belongs to, kept after its bid is removed
+	vector<Bid> bids; // record of each slot, bidId 0 once removed
+	unordered_map<uint32_t, Bid> pending; // inserted ids the hash has no slot for yet
+	unsigned int count = 0; // slot bids and pending ones
+	string indexPath; // where the hash is looked for and saved, empty for nowhere
+
+	vector<Bid> live();
+	bool place(const vector<uint32_t>& ids, const vector<Bid>& held);
+	void rebuild(const vector<uint32_t>& ids, const vector<Bid>& held);
 
 public:
-	HashTable();
-	HashTable(unsigned int size);
-	virtual ~HashTable();
+	PerfectHashTable();
+	PerfectHashTable(unsigned int size);
+	virtual ~PerfectHashTable();
+	void SetIndexPath(const string& path);
 	void Insert(Bid bid);
+	void BulkLoad(vector<Bid> bids, unsigned int threads = 0);
 	void PrintAll();
-	void Remove(string bidId);
-	Bid Search(string bidId);
+	void Remove(uint32_t bidId);
+	void Remove(string_view bidId);
+	const Bid* Search(uint32_t bidId);
+	const Bid* Search(string_view bidId);
+	unsigned int Size();
 };
 
 /**
  * Default constructor
  */
-HashTable::HashTable() {
-	nodes.resize(tableSize); // Initalize node structure by resizing tableSize
+PerfectHashTable::PerfectHashTable() {
 }
 
 /**
- * Constructor for specifying size of the table
- * Use to improve efficiency of hashing algorithm
- * by reducing collisions without wasting memory.
+ * Constructor matching the other tables, the slots are only known once the
+ * ids are, so the size is not used
  */
-HashTable::HashTable(unsigned int size) {
-	this->tableSize = size; // invoke local tableSize to size with this->
-	nodes.resize(tableSize); // resize nodes size
+PerfectHashTable::PerfectHashTable(unsigned int /*size*/) {
 }
 
+/**
+ * Destructor, the arrays free themselves
+ */
+PerfectHashTable::~PerfectHashTable() {
+}
 
 /**
- * Destructor
- * 
- * Guarantees that the memory will be freed by calling the destructor
+ * Set the file the hash is read from and saved to by BulkLoad
+ *
+ * @param path Usually PerfectHash::PathFor() of the bid file, empty to use none
  */
-HashTable::~HashTable() {
-	// nodes.erase(nodes.begin()); // An option, incredibly inefficient
-	vector<Node> nodes; // By reassigning the vector, we deallocate the original vectors memory
+void PerfectHashTable::SetIndexPath(const string& path) {
+	indexPath = path;
 }
 
 /**
- * Calculate the hash value of a given key.
- * Note that key is specifically defined as
- * unsigned int to prevent undefined results
- * of a negative list index.
+ * Copy of every bid still in the table, pending ones included
+ */
+vector<Bid> PerfectHashTable::live() {
+	vector<Bid> held;
+	held.reserve(count);
+	for (const Bid& bid : bids) {
+		if (bid.bidId != 0) {
+			held.push_back(bid);
+		}
+	}
+	for (const auto& entry : pending) {
+		held.push_back(entry.second);
+	}
+	return held;
+}
+
+/**
+ * Give every id a slot by the current hash and put the bids in theirs
  *
- * @param key The key to hash
- * @return The calculated hash
+ * @param ids Distinct, non-zero ids
+ * @param held Every bid of the table, each with one of the ids
+ * @return false if the hash doesn't fit the ids, the slots are then invalid
  */
-unsigned int HashTable::hash(int key) {
-	return key % tableSize;
+bool PerfectHashTable::place(const vector<uint32_t>& ids, const vector<Bid>& held) {
+	if (index.Size() != ids.size()) {
+		return false;
+	}
+	keys.assign(ids.size(), 0);
+	bids.assign(ids.size(), Bid());
+	for (uint32_t id : ids) {
+		uint32_t slot = index.Index(id);
+		if (keys[slot] != 0) { // two ids share a slot, the hash was built for another set
+			return false;
+		}
+		keys[slot] = id;
+	}
+	for (const Bid& bid : held) {
+		bids[index.Index(bid.bidId)] = bid;
+	}
+	pending.clear();
+	count = static_cast<unsigned int>(held.size());
+	return true;
 }
 
 /**
- * Insert a bid
+ * Build the hash for a set of ids and lay the bids out by it
+ *
+ * @param ids Distinct, non-zero ids
+ * @param held Bids to store, each with one of the ids
+ */
+void PerfectHashTable::rebuild(const vector<uint32_t>& ids, const vector<Bid>& held) {
+	if (!index.Build(ids) || !place(ids, held)) {
+		throw runtime_error("PerfectHashTable could not build its hash");
+	}
+}
+
+/**
+ * Insert a bid. One whose id has a slot takes it, a bid with the same id
+ * is replaced; any other id waits in pending until there are enough of
+ * them to be worth building the hash again.
  *
  * @param bid The bid to insert
  */
-void HashTable::Insert(Bid bid) {
-	unsigned key = hash(atoi(bid.bidId.c_str())); // Bid ID is converted to string of characters from string object, ascii to integer is then called, the key is now finalized
-	// Or put another way, we take the bidId, grab the c string, revert to int, call the hash for a key to have an index to the vector
-	Node* node = &(nodes.at(key)); // Gets the address of the node at the key position
-	if (node == nullptr) { // if no entry found for the key
-		Node* newNode = new Node(bid, key); // assign this node to the key position
-		nodes.insert(nodes.begin() + key, (*newNode)); // Insert into the vector from the offset with the address of the node
+void PerfectHashTable::Insert(Bid bid) {
+	if (bid.bidId == 0) {
+		return;
 	}
-	else if (node->key == UINT_MAX) { // else if node is not used but found
-		node->key = key; // assing old node key to UNIT_MAX, set to key, set old node to bid and old node next to null pointer
-		node->bid = bid;
-		node->next = nullptr;
+	if (index.Size() != 0) {
+		uint32_t slot = index.Index(bid.bidId);
+		if (keys[slot] == bid.bidId) {
+			if (bids[slot].bidId == 0) {
+				++count;
+			}
+			bids[slot] = bid;
+			return;
+		}
 	}
-	else { // else find the next open node
-		while (node->next != nullptr) { // Iterates through, stops when the last node is reached (next is nullptr)
-			node = node->next; // Make the next node the "current" node
+
+	auto inserted = pending.insert_or_assign(bid.bidId, bid);
+	if (inserted.second) {
+		++count;
+	}
+	if (pending.size() < max(MIN_PENDING, static_cast<unsigned int>(keys.size()) / 8)) {
+		return;
+	}
+
+	// Removed ids stay in, so taking bids out and putting them back doesn't rebuild again
+	vector<uint32_t> ids = keys;
+	for (const auto& entry : pending) {
+		ids.push_back(entry.first);
+	}
+	rebuild(ids, live());
+}
+
+/**
+ * Insert many bids at once, with the hash built a single time. A hash that
+ * already fits the ids, the table's own or the one in the index file, is
+ * used as is; otherwise a new one is built and saved to the index file.
+ * A later bid with the same id replaces an earlier one, bids without an id
+ * are left out. Building is single threaded; threads is only there to
+ * match the other tables.
+ *
+ * @param bids The bids to insert
+ */
+void PerfectHashTable::BulkLoad(vector<Bid> bids, unsigned int /*threads*/) {
+	vector<Bid> all = live();
+	all.insert(all.end(), bids.begin(), bids.end());
+	stable_sort(all.begin(), all.end(), [](const Bid& a, const Bid& b) {
+		return a.bidId < b.bidId;
+	});
+	vector<Bid> distinct;
+	vector<uint32_t> ids;
+	distinct.reserve(all.size());
+	ids.reserve(all.size());
+	for (size_t i = 0; i < all.size(); ++i) {
+		if (all[i].bidId != 0 && (i + 1 == all.size() || all[i + 1].bidId != all[i].bidId)) { // last of its id
+			distinct.push_back(all[i]);
+			ids.push_back(all[i].bidId);
 		}
-		node->next = new Node(bid, key); // add new newNode to end
+	}
+
+	if (place(ids, distinct)) {
+		return;
+	}
+	if (!indexPath.empty() && index.Load(indexPath) && place(ids, distinct)) {
+		return;
+	}
+	rebuild(ids, distinct);
+	if (!indexPath.empty()) {
+		index.Save(indexPath); // only saves the next load a rebuild, failing is harmless
 	}
 }
 
 /**
  * Print all bids
  */
-void HashTable::PrintAll() {
-	for (unsigned int i = 0; i < nodes.size(); ++i) { // for node begin to end iterate
-		Node* current = &(nodes.at(i)); // Address of the first node passed to current
-		if (current->key != UINT_MAX && current != nullptr) {
-			cout << current->key << current->bid.bidId << ": " << current->bid.title
-				<< " | " << current->bid.amount << " | " << current->bid.fund << endl; // output key, bidID, title, amount and fund
-			current = current->next; // node is equal to next iter
+void PerfectHashTable::PrintAll() {
+	for (const Bid& bid : bids) {
+		if (bid.bidId != 0) {
+			cout << bid.bidId << ": " << bid.Title() << " | " << bid.Dollars() << " | "
+				<< bid.Fund() << endl;
 		}
 	}
-	return;
+	for (const auto& entry : pending) {
+		const Bid& bid = entry.second;
+		cout << bid.bidId << ": " << bid.Title() << " | " << bid.Dollars() << " | "
+			<< bid.Fund() << endl;
+	}
 }
 
 /**
- * Remove a bid
+ * Remove a bid, its id keeps the slot so putting it back needs no rebuild
  *
- * @param bidId The bid id to search for
+ * @param bidId The bid id to remove
  */
-void HashTable::Remove(string bidId) {
-	unsigned key = hash(atoi(bidId.c_str())); // set key equal to hash atoi bidID cstring
-	nodes.erase(nodes.begin() + key); // erase node begin and key
+void PerfectHashTable::Remove(uint32_t bidId) {
+	if (pending.erase(bidId) != 0) {
+		--count;
+		return;
+	}
+	if (index.Size() == 0) {
+		return;
+	}
+	Bid& held = bids[index.Index(bidId)];
+	if (bidId != 0 && held.bidId == bidId) {
+		held = Bid();
+		--count;
+	}
 }
 
 /**
- * Search for the specified bidId
+ * Search for the specified bidId, one slot is read and then, if the id
+ * isn't there, the pending bids
  *
  * @param bidId The bid id to search for
+ * @return The bid in the table, valid until the table is next changed, or nullptr
  */
-Bid HashTable::Search(string bidId) {
-	Bid bid;
-	unsigned key = hash(atoi(bidId.c_str())); // calculate and create the key for the given bid
-	Node* node = &(nodes.at(key));
-
-	if (node != nullptr && node->key != UINT_MAX // if the entry exists AND is not unused
-		&& node->bid.bidId.compare(bidId) == 0) { // AND is matching to the searched bidId
-		return node->bid; //return node bid
+const Bid* PerfectHashTable::Search(uint32_t bidId) {
+	if (index.Size() != 0) {
+		const Bid& held = bids[index.Index(bidId)];
+		if (bidId != 0 && held.bidId == bidId) {
+			return &held;
+		}
 	}
-	else if (node == nullptr || node->key == UINT_MAX) { // if no entry found for the key OR it is unused
-		return bid;
+	if (pending.empty()) {
+		return nullptr;
 	}
-	else {
-		while (node != nullptr) { // while node not equal to nullptr
-			if (node->key != UINT_MAX && node->bid.bidId.compare(bidId) == 0) {// if the current node matches, return it
-				return node->bid;
-			}
-			node = node->next; // node is equal to next node
-		}
-		return bid; // if you fall out of while, return an empty bid
+	auto found = pending.find(bidId);
+	return found != pending.end() ? &found->second : nullptr;
+}
+
+/**
+ * Remove a bid by its Auction ID as text
+ */
+void PerfectHashTable::Remove(string_view bidId) {
+	uint32_t id;
+	if (ParseBidId(bidId, id)) {
+		Remove(id);
 	}
 }
 
+/**
+ * Search by the Auction ID as text, the text is parsed in place
+ */
+const Bid* PerfectHashTable::Search(string_view bidId) {
+	uint32_t id;
+	if (!ParseBidId(bidId, id)) { // not an Auction ID
+		return nullptr;
+	}
+	return Search(id);
+}
+
+/**
+ * Number of bids in the table
+ */
+unsigned int PerfectHashTable::Size() {
+	return count;
+}
+
+//============================================================================
+// Table used by the menu
+//============================================================================
+
+// Any of the tables above, they share one interface. Pick another at compile time
+// with e.g. /DBID_TABLE=RobinHoodHashTable
+#ifndef BID_TABLE
+#define BID_TABLE HashTable
+#endif
+typedef BID_TABLE BidTable;
+
 //============================================================================
 // Static methods used for testing
 //============================================================================
@@ -216,23 +2082,52 @@ Bid HashTable::Search(string bidId) {
  *
  * @param bid struct containing the bid info
  */
-void displayBid(Bid bid) {
-	cout << bid.bidId << ": " << bid.title << " | " << bid.amount << " | "
-		<< bid.fund << endl;
+void displayBid(const Bid& bid) {
+	cout << bid.bidId << ": " << bid.Title() << " | " << bid.Dollars() << " | "
+		<< bid.Fund() << endl;
 	return;
 }
 
+/**
+ * Point a PerfectHashTable at the index file that belongs to a CSV file,
+ * other tables have none and skip this at compile time
+ */
+template <typename Table>
+void useIndexFile(Table* table, const string& csvPath) {
+	if constexpr (is_same_v<Table, PerfectHashTable>) {
+		table->SetIndexPath(PerfectHash::PathFor(csvPath));
+	}
+}
+
 /**
  * Load a CSV file containing bids into a container
  *
  * @param csvPath the path to the CSV file to load
  * @return a container holding all the bids read
  */
-void loadBids(string csvPath, HashTable* hashTable) {
+void loadBids(string csvPath, BidTable* hashTable) {
+	useIndexFile(hashTable, csvPath);
+
+	// A fresh snapshot of this file skips the CSV parse entirely
+	BidSnapshot snapshot;
+	if (snapshot.Open(csvPath)) {
+		cout << "Loading snapshot " << BidSnapshot::PathFor(csvPath) << endl;
+		vector<Bid> bids(snapshot.Size()); // the count is known, one allocation
+		for (size_t i = 0; i < snapshot.Size(); ++i) {
+			bids[i].bidId = snapshot.BidId(i);
+			bids[i].title = bidStrings.Add(snapshot.Title(i));
+			bids[i].fund = bidStrings.Intern(snapshot.Fund(i));
+			bids[i].amount = snapshot.Amount(i);
+		}
+		hashTable->BulkLoad(move(bids));
+		return;
+	}
+
 	cout << "Loading CSV file " << csvPath << endl;
 
-	// initialize the CSV Parser using the given path
-	csv::Parser file = csv::Parser(csvPath);
+	// stream the CSV file using the given path, rows are parsed while the file is still being read.
+	// Only the columns a Bid uses are split out.
+	csv::Stream file(csvPath, BID_COLUMNS);
 
 	// read and display header row - optional
 	vector<string> header = file.getHeader();
@@ -241,21 +2136,30 @@ void loadBids(string csvPath, HashTable* hashTable) {
 	}
 	cout << "" << endl;
 
+	BidSnapshotWriter writer; // remembers every bid for the next start
+	vector<Bid> bids; // collected first so the table is sized and filled in one go
+
 	try {
 		// loop to read rows of a CSV file
-		for (unsigned int i = 0; i < file.rowCount(); i++) {
+		for (csv::Row& row : file) { // one row buffer is reused for every record
 
 			// Create a data structure and add to the collection of bids
 			Bid bid;
-			bid.bidId = file[i][1];
-			bid.title = file[i][0];
-			bid.fund = file[i][8];
-			bid.amount = strToDouble(file[i][4], '$');
+			if (!BidFromRow(row, bid)) {
+				continue;
+			}
 
 			//cout << "Item: " << bid.title << ", Fund: " << bid.fund << ", Amount: " << bid.amount << endl;
 
 			// push this bid to the end
-			hashTable->Insert(bid);
+			writer.Add(bid.bidId, bid.Title(), bid.Fund(), bid.amount);
+			bids.push_back(bid);
+		}
+		hashTable->BulkLoad(move(bids));
+
+		// only a complete load is worth keeping
+		if (!writer.Write(csvPath)) {
+			cerr << "Could not write snapshot " << BidSnapshot::PathFor(csvPath) << endl;
 		}
 	}
 	catch (csv::Error& e) {
@@ -264,16 +2168,120 @@ void loadBids(string csvPath, HashTable* hashTable) {
 }
 
 /**
- * Simple C function to convert a string to a double
- * after stripping out unwanted char
+ * Multi-threaded stress and throughput run of ConcurrentHashTable.
+ * The first half of the bids is loaded up front, then a loader thread
+ * inserts the second half while worker threads search random ids; every
+ * 16th operation a worker removes and re-inserts one of its own bids.
+ * Afterwards every bid must still be found.
  *
- * credit: http://stackoverflow.com/a/24875936
- *
- * @param ch The character to strip out
+ * @param csvPath the path to the CSV file to load
+ */
+void concurrentBenchmark(string csvPath) {
+	StringPool::Mark before = bidStrings.Position(); // the benchmark's text goes again when it is done
+	vector<Bid> bids;
+	try {
+		csv::Stream file(csvPath, BID_COLUMNS);
+		for (csv::Row& row : file) {
+			Bid bid;
+			if (!BidFromRow(row, bid)) {
+				continue;
+			}
+			bids.push_back(bid);
+		}
+	}
+	catch (csv::Error& e) {
+		std::cerr << e.what() << std::endl;
+		bidStrings.Rewind(before);
+		return;
+	}
+	if (bids.empty()) {
+		return;
+	}
+
+	const unsigned int OPERATIONS = 200000; // per worker
+	cout << bids.size() << " bids, " << OPERATIONS << " operations per worker, "
+		<< thread::hardware_concurrency() << " hardware threads" << endl;
+
+	for (unsigned int workers = 1; workers <= 32; workers *= 2) {
+		ConcurrentHashTable table;
+		size_t half = bids.size() / 2;
+		for (size_t i = 0; i < half; ++i) {
+			table.Insert(bids[i]);
+		}
+
+		auto start = chrono::steady_clock::now();
+		vector<thread> threads;
+		threads.emplace_back([&]() { // the loader
+			for (size_t i = half; i < bids.size(); ++i) {
+				table.Insert(bids[i]);
+			}
+		});
+		atomic<unsigned int> found(0);
+		for (unsigned int w = 0; w < workers; ++w) {
+			threads.emplace_back([&, w]() {
+				minstd_rand random(w + 1);
+				unsigned int hits = 0;
+				for (unsigned int i = 0; i < OPERATIONS; ++i) {
+					const Bid& bid = bids[random() % bids.size()];
+					if (i % 16 == 0 && bid.bidId % workers == w) { // only this worker touches these ids
+						table.Remove(bid.bidId);
+						table.Insert(bid);
+					}
+					else if (table.Search(bid.bidId)) {
+						++hits;
+					}
+				}
+				found += hits;
+			});
+		}
+		for (thread& t : threads) {
+			t.join();
+		}
+		double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+		unsigned int missing = 0;
+		for (const Bid& bid : bids) {
+			optional<Bid> held = table.Search(bid.bidId);
+			if (!held || held->bidId != bid.bidId) {
+				++missing;
+			}
+		}
+		cout << "  " << workers << " workers: " << (workers * OPERATIONS) / seconds / 1e6 << " million ops/s, "
+			<< found << " hits, " << missing << " bids missing after the run" << endl;
+	}
+	bidStrings.Rewind(before);
+}
+
+/**
+ * Print the Bloom filter counters of a table that has one
+ */
+void printFilterStats(HashTable* table) {
+	table->Filter().PrintStats();
+}
+
+template <typename Table>
+void printFilterStats(Table*) {
+	cout << "This table has no Bloom filter" << endl;
+}
+
+/**
+ * Print the bucket and probe stats of a table that keeps them
  */
-double strToDouble(string str, char ch) {
-	str.erase(remove(str.begin(), str.end(), ch), str.end());
-	return atof(str.c_str());
+void printTableStats(HashTable* table) {
+	table->Stats().Print();
+}
+
+void printTableStats(RobinHoodHashTable* table) {
+	table->Stats().Print();
+}
+
+void printTableStats(SwissHashTable* table) {
+	table->Stats().Print();
+}
+
+template <typename Table>
+void printTableStats(Table*) {
+	cout << "This table has no stats" << endl;
 }
 
 /**
@@ -311,10 +2319,9 @@ int main(int argc, char* argv[]) {
 	clock_t ticks;
 
 	// Define a hash table to hold all the bids
-	HashTable* bidTable;
+	BidTable* bidTable;
 
-	Bid bid;
-	bidTable = new HashTable();
+	bidTable = new BidTable();
 
 	int choice = 0;
 	while (choice != 9) {
@@ -323,6 +2330,9 @@ int main(int argc, char* argv[]) {
 		cout << "  2. Display All Bids" << endl;
 		cout << "  3. Find Bid" << endl;
 		cout << "  4. Remove Bid" << endl;
+		cout << "  5. Concurrent Table Benchmark" << endl;
+		cout << "  6. Bloom Filter Stats" << endl;
+		cout << "  7. Table Stats" << endl;
 		cout << "  9. Exit" << endl;
 		cout << "Enter choice: ";
 		cin >> choice;
@@ -336,6 +2346,11 @@ int main(int argc, char* argv[]) {
 			// Initialize a timer variable before loading bids
 			ticks = clock();
 
+			// A reload replaces the table, and the text of its bids with it
+			delete bidTable;
+			bidStrings.Reset();
+			bidTable = new BidTable();
+
 			// Complete the method call to load the bids
 			loadBids(csvPath, bidTable);
 
@@ -349,15 +2364,15 @@ int main(int argc, char* argv[]) {
 			bidTable->PrintAll();
 			break;
 
-		case 3:
+		case 3: {
 			ticks = clock();
 
-			bid = bidTable->Search(searchValue);
+			auto found = bidTable->Search(searchValue); // points at the stored bid, ConcurrentHashTable hands back a copy
 
 			ticks = clock() - ticks; // current clock ticks minus starting clock ticks
 
-			if (!bid.bidId.empty()) {
-				displayBid(bid);
+			if (found) {
+				displayBid(*found);
 			}
 			else {
 				cout << "Bid Id " << searchValue << " not found." << endl;
@@ -366,10 +2381,23 @@ int main(int argc, char* argv[]) {
 			cout << "time: " << ticks << " clock ticks" << endl;
 			cout << "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
 			break;
+		}
 
 		case 4:
 			bidTable->Remove(searchValue);
 			break;
+
+		case 5:
+			concurrentBenchmark(csvPath);
+			break;
+
+		case 6:
+			printFilterStats(bidTable);
+			break;
+
+		case 7:
+			printTableStats(bidTable);
+			break;
 		}
 	}
 
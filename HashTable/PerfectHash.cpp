@@ -0,0 +1,355 @@
+//============================================================================
+// Name        : PerfectHash.cpp
+// Author      : Connor Sculthorpe
+// Version     : 1.0
+// Description : Minimal perfect hash over a fixed set of bid ids, saved next
+//               to the bid file so it is built once
+//============================================================================
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <system_error>
+
+#include "PerfectHash.hpp"
+
+using namespace std;
+
+namespace {
+
+const uint32_t KEYS_PER_BUCKET = 4; // average, fewer pilots to store against more tries per pilot
+const unsigned int MAX_SEEDS = 16; // fresh seeds tried before Build() gives up
+
+/*
+ * File layout, little endian:
+ *   Header   fixed size
+ *   pilots   header.bucketCount uint16_t, padded to a multiple of 4 bytes
+ *   remap    header.slotCount - header.keyCount uint32_t
+ * The checksum covers the header, taken with its checksum field at 0, then
+ * pilots and remap.
+ */
+struct PerfectHashHeader {
+	char magic[8]; // "BIDMPH\0\0"
+	uint32_t version;
+	uint32_t keyCount;
+	uint32_t slotCount;
+	uint32_t bucketCount;
+	uint64_t seed;
+	uint64_t checksum;
+};
+
+static_assert(sizeof(PerfectHashHeader) == 40, "perfect hash header layout changed");
+
+const char INDEX_MAGIC[8] = { 'B', 'I', 'D', 'M', 'P', 'H', '\0', '\0' };
+const uint32_t INDEX_VERSION = 2; // 2: the checksum covers the header
+
+/**
+ * FNV-1a, continued from a previous hash
+ *
+ * @param hash Hash so far
+ * @param data Bytes to add
+ * @param size Number of bytes
+ * @return The updated hash
+ */
+uint64_t checksum(uint64_t hash, const void* data, size_t size) {
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	for (size_t i = 0; i < size; ++i) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL; // FNV prime
+	}
+	return hash;
+}
+
+const uint64_t CHECKSUM_SEED = 14695981039346656037ULL; // FNV offset basis
+
+} // namespace
+
+/**
+ * splitmix64 finalizer, a bijection so distinct keys never share a hash
+ */
+uint64_t PerfectHash::mix(uint64_t key) {
+	key += 0x9E3779B97F4A7C15ULL;
+	key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	key = (key ^ (key >> 27)) * 0x94D049BB133111EBULL;
+	return key ^ (key >> 31);
+}
+
+uint64_t PerfectHash::keyHash(uint32_t key) const {
+	return mix(key ^ seed);
+}
+
+/**
+ * The bucket of a key hash, from its high half by multiply and shift
+ */
+uint32_t PerfectHash::bucketOf(uint64_t hash) const {
+	return static_cast<uint32_t>(((hash >> 32) * pilots.size()) >> 32);
+}
+
+/**
+ * The position a pilot sends a key hash to, in [0, slotCount).
+ * The multiply carries every bit into the high half, so two hashes that
+ * only differ low down still move apart as the pilot changes.
+ */
+uint32_t PerfectHash::position(uint64_t hash, uint16_t pilot) const {
+	uint64_t moved = (hash ^ mix(seed + pilot)) * 0x9E3779B97F4A7C15ULL;
+	return static_cast<uint32_t>(((moved >> 32) * slotCount) >> 32);
+}
+
+/**
+ * Look for a pilot for every bucket with the current seed
+ *
+ * @param keys Distinct keys
+ * @return false if some bucket has no pilot that fits, a new seed is needed
+ */
+bool PerfectHash::tryBuild(const vector<uint32_t>& keys) {
+	uint32_t bucketCount = static_cast<uint32_t>(pilots.size());
+
+	// Group the key hashes by bucket
+	vector<uint32_t> starts(bucketCount + 1, 0);
+	for (uint32_t key : keys) {
+		++starts[bucketOf(keyHash(key)) + 1];
+	}
+	for (uint32_t b = 0; b < bucketCount; ++b) {
+		starts[b + 1] += starts[b];
+	}
+	vector<uint64_t> hashes(keys.size());
+	vector<uint32_t> next(starts.begin(), starts.end() - 1);
+	for (uint32_t key : keys) {
+		uint64_t hash = keyHash(key);
+		hashes[next[bucketOf(hash)]++] = hash;
+	}
+
+	// Largest buckets first, while most positions are still free
+	vector<uint32_t> order(bucketCount);
+	iota(order.begin(), order.end(), 0);
+	stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+		return starts[a + 1] - starts[a] > starts[b + 1] - starts[b];
+	});
+
+	vector<bool> taken(slotCount, false);
+	vector<uint32_t> placed;
+	for (uint32_t b : order) {
+		uint32_t first = starts[b];
+		uint32_t last = starts[b + 1];
+		if (first == last) { // only empty buckets left, their pilot is never read
+			break;
+		}
+
+		bool found = false;
+		for (uint32_t pilot = 0; pilot <= UINT16_MAX && !found; ++pilot) {
+			placed.clear();
+			for (uint32_t i = first; i < last; ++i) {
+				uint32_t at = position(hashes[i], static_cast<uint16_t>(pilot));
+				if (taken[at] || find(placed.begin(), placed.end(), at) != placed.end()) {
+					break;
+				}
+				placed.push_back(at);
+			}
+			if (placed.size() == last - first) {
+				for (uint32_t at : placed) {
+					taken[at] = true;
+				}
+				pilots[b] = static_cast<uint16_t>(pilot);
+				found = true;
+			}
+		}
+		if (!found) {
+			return false;
+		}
+	}
+
+	// Exactly as many indices below keyCount are free as positions at or past it are taken
+	remap.assign(slotCount - keyCount, 0);
+	uint32_t unused = 0;
+	for (uint32_t at = keyCount; at < slotCount; ++at) {
+		if (taken[at]) {
+			while (taken[unused]) {
+				++unused;
+			}
+			remap[at - keyCount] = unused++;
+		}
+	}
+	return true;
+}
+
+/**
+ * Build the hash for a set of keys, duplicates count once
+ *
+ * @param keys The keys, Index() maps each to its own value below their count
+ * @return false if no pilots were found, which is vanishingly rare
+ */
+bool PerfectHash::Build(vector<uint32_t> keys) {
+	sort(keys.begin(), keys.end());
+	keys.erase(unique(keys.begin(), keys.end()), keys.end());
+	Clear();
+	if (keys.empty()) {
+		return true;
+	}
+
+	keyCount = static_cast<uint32_t>(keys.size());
+	slotCount = keyCount + keyCount / 100 + 1; // 99% of the positions end up taken
+	for (unsigned int attempt = 1; attempt <= MAX_SEEDS; ++attempt) {
+		seed = mix(attempt);
+		pilots.assign((keyCount + KEYS_PER_BUCKET - 1) / KEYS_PER_BUCKET, 0);
+		if (tryBuild(keys)) {
+			return true;
+		}
+	}
+	Clear();
+	return false;
+}
+
+/**
+ * Forget the keys, Size() is 0 afterwards
+ */
+void PerfectHash::Clear() {
+	seed = 0;
+	keyCount = 0;
+	slotCount = 0;
+	vector<uint16_t>().swap(pilots);
+	vector<uint32_t>().swap(remap);
+}
+
+/**
+ * The index of a key, only call it while Size() is not 0
+ *
+ * @param key The key to look up
+ * @return Its index below Size(), a key that wasn't built in gets any index
+ */
+uint32_t PerfectHash::Index(uint32_t key) const {
+	uint64_t hash = keyHash(key);
+	uint32_t at = position(hash, pilots[bucketOf(hash)]);
+	return at < keyCount ? at : remap[at - keyCount];
+}
+
+/**
+ * Number of keys it was built for
+ */
+size_t PerfectHash::Size() const {
+	return keyCount;
+}
+
+/**
+ * Memory held by the pilots and the remap table
+ */
+size_t PerfectHash::Bytes() const {
+	return pilots.size() * sizeof(uint16_t) + remap.size() * sizeof(uint32_t);
+}
+
+/**
+ * Path of the index that belongs to a CSV file
+ *
+ * @param csvPath The CSV file
+ * @return The index path
+ */
+string PerfectHash::PathFor(const string& csvPath) {
+	return csvPath + ".mph";
+}
+
+/**
+ * Write the hash to a file. It goes to a temporary file first so a
+ * reader never sees half an index.
+ *
+ * @param path Where to write it
+ * @return false if it could not be written
+ */
+bool PerfectHash::Save(const string& path) const {
+	PerfectHashHeader header;
+	memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+	header.version = INDEX_VERSION;
+	header.keyCount = keyCount;
+	header.slotCount = slotCount;
+	header.bucketCount = static_cast<uint32_t>(pilots.size());
+	header.seed = seed;
+	header.checksum = 0;
+
+	string padding((pilots.size() % 2) * sizeof(uint16_t), '\0'); // keeps remap 4-byte aligned
+	uint64_t sum = checksum(CHECKSUM_SEED, &header, sizeof(header));
+	header.checksum = checksum(sum, pilots.data(), pilots.size() * sizeof(uint16_t));
+	header.checksum = checksum(header.checksum, padding.data(), padding.size());
+	header.checksum = checksum(header.checksum, remap.data(), remap.size() * sizeof(uint32_t));
+
+	string tempPath = path + ".tmp";
+	{
+		ofstream out(tempPath, ios::binary | ios::trunc);
+		out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		out.write(reinterpret_cast<const char*>(pilots.data()), pilots.size() * sizeof(uint16_t));
+		out.write(padding.data(), padding.size());
+		out.write(reinterpret_cast<const char*>(remap.data()), remap.size() * sizeof(uint32_t));
+		if (!out) {
+			return false;
+		}
+	}
+
+	error_code error;
+	filesystem::rename(tempPath, path, error);
+	if (error) {
+		filesystem::remove(tempPath, error);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Read a hash written by Save(). Whether it fits the keys at hand is
+ * up to the caller: it does if no two of them share an index.
+ *
+ * @param path The file to read
+ * @return false if there is no such file or it is damaged, the hash is cleared
+ */
+bool PerfectHash::Load(const string& path) {
+	Clear();
+	ifstream in(path, ios::binary);
+	PerfectHashHeader header;
+	if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))
+		|| memcmp(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0
+		|| header.version != INDEX_VERSION
+		|| header.slotCount < header.keyCount
+		|| header.bucketCount != (header.keyCount + KEYS_PER_BUCKET - 1) / KEYS_PER_BUCKET) {
+		return false;
+	}
+
+	// The counts must match the file before they size anything
+	uint64_t pilotBytes = (uint64_t(header.bucketCount) + header.bucketCount % 2) * sizeof(uint16_t);
+	uint64_t remapBytes = uint64_t(header.slotCount - header.keyCount) * sizeof(uint32_t);
+	error_code error;
+	uintmax_t fileSize = filesystem::file_size(path, error);
+	if (error || fileSize != sizeof(header) + pilotBytes + remapBytes) {
+		return false;
+	}
+
+	uint64_t expected = header.checksum;
+	header.checksum = 0;
+	uint64_t sum = checksum(CHECKSUM_SEED, &header, sizeof(header));
+
+	vector<uint16_t> readPilots(header.bucketCount);
+	string padding((header.bucketCount % 2) * sizeof(uint16_t), '\0');
+	vector<uint32_t> readRemap(header.slotCount - header.keyCount);
+	in.read(reinterpret_cast<char*>(readPilots.data()), readPilots.size() * sizeof(uint16_t));
+	in.read(&padding[0], padding.size());
+	in.read(reinterpret_cast<char*>(readRemap.data()), readRemap.size() * sizeof(uint32_t));
+	if (!in || in.peek() != ifstream::traits_type::eof()) {
+		return false;
+	}
+
+	sum = checksum(sum, readPilots.data(), readPilots.size() * sizeof(uint16_t));
+	sum = checksum(sum, padding.data(), padding.size());
+	sum = checksum(sum, readRemap.data(), readRemap.size() * sizeof(uint32_t));
+	if (sum != expected) {
+		return false;
+	}
+	for (uint32_t index : readRemap) {
+		if (index >= header.keyCount) {
+			return false;
+		}
+	}
+
+	seed = header.seed;
+	keyCount = header.keyCount;
+	slotCount = header.slotCount;
+	pilots.swap(readPilots);
+	remap.swap(readRemap);
+	return true;
+}
@@ -0,0 +1,54 @@
+//============================================================================
+// Name        : PerfectHash.hpp
+// Author      : Connor Sculthorpe
+// Version     : 1.0
+// Description : Minimal perfect hash over a fixed set of bid ids, saved next
+//               to the bid file so it is built once
+//============================================================================
+
+#ifndef PERFECTHASH_HPP
+#define PERFECTHASH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * PTHash-style minimal perfect hash: maps each of n distinct keys to its own
+ * index in [0, n) with no collisions, so a lookup is one probe.
+ *
+ * Keys are split into small buckets. Every bucket stores a pilot, chosen at
+ * build time so that its keys land on positions nobody else took. Positions
+ * run a little past n to make the last buckets easy to place, the few keys
+ * that land past n are sent to the unused indices below it through a remap
+ * table. A key outside the set still gets some index, the caller checks it.
+ */
+class PerfectHash {
+
+private:
+	uint64_t seed = 0;
+	uint32_t keyCount = 0;
+	uint32_t slotCount = 0; // positions a pilot can pick, a bit over keyCount
+	std::vector<uint16_t> pilots; // one per bucket
+	std::vector<uint32_t> remap; // index for positions keyCount and up
+
+	static uint64_t mix(uint64_t key);
+	uint64_t keyHash(uint32_t key) const;
+	uint32_t bucketOf(uint64_t hash) const;
+	uint32_t position(uint64_t hash, uint16_t pilot) const;
+	bool tryBuild(const std::vector<uint32_t>& keys);
+
+public:
+	bool Build(std::vector<uint32_t> keys);
+	void Clear();
+	uint32_t Index(uint32_t key) const;
+	size_t Size() const;
+	size_t Bytes() const;
+	bool Save(const std::string& path) const;
+	bool Load(const std::string& path);
+
+	static std::string PathFor(const std::string& csvPath);
+};
+
+#endif // PERFECTHASH_HPP
@@ -10,6 +10,7 @@
 #include <iostream>
 #include <time.h>
 
+#include "Bid.hpp"
 #include "CSVparser.hpp"
 
 using namespace std;
@@ -21,17 +22,6 @@ using namespace std;
 // forward declarations
 double strToDouble(string str, char ch);
 
-// define a structure to hold bid information
-struct Bid {
-	string bidId; // unique identifier
-	string title;
-	string fund;
-	double amount;
-	Bid() {
-		amount = 0.0;
-	}
-};
-
 //============================================================================
 // Linked-List class definition
 //============================================================================
@@ -70,8 +60,10 @@ public:
 	void Append(Bid bid);
 	void Prepend(Bid bid);
 	void PrintList();
-	void Remove(string bidId);
-	Bid Search(string bidId);
+	void Remove(uint32_t bidId);
+	void Remove(string_view bidId);
+	const Bid* Search(uint32_t bidId);
+	const Bid* Search(string_view bidId);
 	int Size();
 };
 
@@ -136,8 +128,8 @@ void LinkedList::PrintList() {
 	Node* current = head; // Start at the head
 
 	while (current != nullptr) { // While loop over each node looking for a match
-			cout << current->bid.bidId << ": " << current->bid.title << " | " << current->bid.amount << " | "
-				<< current->bid.fund << endl; // Output the current bidID, title, amount, and fund
+			cout << current->bid.bidId << ": " << current->bid.Title() << " | " << current->bid.Dollars() << " | "
+				<< current->bid.Fund() << endl; // Output the current bidID, title, amount, and fund
 			current = current->next; // Set current equal to next
 		}
 }
@@ -147,7 +139,7 @@ void LinkedList::PrintList() {
  *
  * @param bidId The bid id to remove from the list
  */
-void LinkedList::Remove(string bidId) {
+void LinkedList::Remove(uint32_t bidId) {
 	Node* current = head; // Start from the head node
 	Node* previous = nullptr; // Set null until we obtain a previous node
 
@@ -190,21 +182,43 @@ void LinkedList::Remove(string bidId) {
 
 }
 
+/**
+ * Remove a specified bid by its Auction ID as text
+ */
+void LinkedList::Remove(string_view bidId) {
+	uint32_t id;
+	if (ParseBidId(bidId, id)) {
+		Remove(id);
+	}
+}
+
 /**
  * Search for the specified bidId
  *
  * @param bidId The bid id to search for
+ * @return The bid in its node, valid until it is removed, or nullptr
  */
-Bid LinkedList::Search(string bidId) {
+const Bid* LinkedList::Search(uint32_t bidId) {
 	Node* current = head;
 
 	while (current != nullptr) { // Loop over each node in the list
 		if (current->bid.bidId == bidId) { // If the current node bidID matches the given bidID
-			return current->bid; // Return the current bid information of the current node
+			return &(current->bid); // Point at the bid of the current node, no copy
 		}
 		current = current->next; // Move to the next node
 	}
-	return Bid(); // Return an empty bid if the bidID is not found
+	return nullptr; // No bid if the bidID is not found
+}
+
+/**
+ * Search by the Auction ID as text, the text is parsed in place
+ */
+const Bid* LinkedList::Search(string_view bidId) {
+	uint32_t id;
+	if (!ParseBidId(bidId, id)) { // not an Auction ID
+		return nullptr;
+	}
+	return Search(id);
 }
 
 /**
@@ -223,9 +237,9 @@ int LinkedList::Size() {
  *
  * @param bid struct containing the bid info
  */
-void displayBid(Bid bid) {
-	cout << bid.bidId << ": " << bid.title << " | " << bid.amount
-		 << " | " << bid.fund << endl;
+void displayBid(const Bid& bid) {
+	cout << bid.bidId << ": " << bid.Title() << " | " << bid.Dollars()
+		 << " | " << bid.Fund() << endl;
 	return;
 }
 
@@ -236,22 +250,29 @@ void displayBid(Bid bid) {
  */
 Bid getBid() {
 	Bid bid;
+	string text;
 
 	cout << "Enter Id: ";
 	cin.ignore();
-	getline(cin, bid.bidId);
+	getline(cin, text);
+	while (!ParseBidId(text, bid.bidId)) {
+		cout << "Not an Auction ID, enter Id: ";
+		getline(cin, text);
+	}
 
 	cout << "Enter title: ";
-	getline(cin, bid.title);
+	getline(cin, text);
+	bid.title = bidStrings.Add(text);
 
 	cout << "Enter fund: ";
-	cin >> bid.fund;
+	cin >> text;
+	bid.fund = bidStrings.Intern(text);
 
 	cout << "Enter amount: ";
 	cin.ignore();
 	string strAmount;
 	getline(cin, strAmount);
-	bid.amount = strToDouble(strAmount, '$');
+	bid.amount = ToCents(strToDouble(strAmount, '$'));
 
 	return bid;
 }
@@ -264,19 +285,19 @@ Bid getBid() {
 void loadBids(string csvPath, LinkedList *list) {
 	cout << "Loading CSV file " << csvPath << endl;
 
-	// initialize the CSV Parser
-	csv::Parser file = csv::Parser(csvPath);
+	// stream the CSV file, rows are parsed while the file is still being read.
+	// Only the columns a Bid uses are split out.
+	csv::Stream file(csvPath, BID_COLUMNS);
 
 	try {
 		// loop to read rows of a CSV file
-		for (int i = 0; i < file.rowCount(); i++) {
+		for (csv::Row& row : file) { // one row buffer is reused for every record
 
 			// initialize a bid using data from current row (i)
 			Bid bid;
-			bid.bidId = file[i][1];
-			bid.title = file[i][0];
-			bid.fund = file[i][8];
-			bid.amount = strToDouble(file[i][4], '$');
+			if (!BidFromRow(row, bid)) {
+				continue;
+			}
 
 			//cout << bid.bidId << ": " << bid.title << " | " << bid.fund << " | " << bid.amount << endl;
 
@@ -381,15 +402,15 @@ int main(int argc, char* argv[]) {
 
 			break;
 
-		case 4:
+		case 4: {
 			ticks = clock();
 
-			bid = bidList.Search(bidKey);
+			const Bid* found = bidList.Search(bidKey);
 
 			ticks = clock() - ticks; // current clock ticks minus starting clock ticks
 
-			if (!bid.bidId.empty()) {
-				displayBid(bid);
+			if (found != nullptr) {
+				displayBid(*found);
 			} else {
 				cout << "Bid Id " << bidKey << " not found." << endl;
 			}
@@ -398,6 +419,7 @@ int main(int argc, char* argv[]) {
 			cout << "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
 
 			break;
+		}
 
 		case 5:
 			bidList.Remove(bidKey);
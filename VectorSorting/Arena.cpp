@@ -0,0 +1,67 @@
+#include <algorithm>
+#include <cstring>
+
+#include "Arena.hpp"
+
+namespace csv {
+
+  /*
+  ** ARENA
+  */
+
+  Arena::Arena(std::size_t blockSize)
+      : _current(0), _used(0), _blockSize(blockSize > 0 ? blockSize : 1) {}
+
+  Arena::~Arena(void)
+  {
+    for (auto it = _blocks.begin(); it != _blocks.end(); it++)
+      delete[] it->data;
+  }
+
+  void *Arena::allocate(std::size_t size, std::size_t align)
+  {
+    while (_current < _blocks.size())
+    {
+      Block &block = _blocks[_current];
+      std::size_t start = (_used + align - 1) & ~(align - 1);
+      if (start + size <= block.size)
+      {
+        _used = start + size;
+        return block.data + start;
+      }
+      _current++; // reuse the next block after a reset(), or make a new one
+      _used = 0;
+    }
+
+    // new blocks are aligned by operator new, oversized requests get their own block
+    Block block = { new char[std::max(size, _blockSize)], std::max(size, _blockSize) };
+    _blocks.push_back(block);
+    _current = _blocks.size() - 1;
+    _used = size;
+    return block.data;
+  }
+
+  std::string_view Arena::copy(std::string_view text)
+  {
+    if (text.empty())
+      return std::string_view();
+    char *data = static_cast<char *>(allocate(text.size(), 1));
+    memcpy(data, text.data(), text.size());
+    return std::string_view(data, text.size());
+  }
+
+  void Arena::reset(void)
+  {
+    _current = 0;
+    _used = 0;
+  }
+
+  void Arena::merge(Arena &other)
+  {
+    // in front of the current block so they're never carved again before a reset()
+    _blocks.insert(_blocks.begin(), other._blocks.begin(), other._blocks.end());
+    _current += other._blocks.size();
+    other._blocks.clear();
+    other.reset();
+  }
+}
@@ -0,0 +1,235 @@
+//============================================================================
+// Name        : Bid.cpp
+// Author      : Connor Sculthorpe
+// Version     : 1.0
+// Description : Compact bid record shared by every bid container, its text
+//               lives in one string pool
+//============================================================================
+
+#include <cmath>
+#include <iostream>
+#include <cstring>
+#include <stdexcept>
+
+#include "Bid.hpp"
+#include "CSVparser.hpp"
+
+using namespace std;
+
+StringPool bidStrings;
+
+const vector<string> BID_COLUMNS = { "Auction Title|ArticleTitle", "Auction ID|ArticleID",
+	"Winning Bid|WinningBid", "Auction Fee Total|Fund" };
+
+//============================================================================
+// StringPool
+//============================================================================
+
+/**
+ * Default constructor, reference 0 is the empty string
+ */
+StringPool::StringPool() {
+	Add(string_view());
+	start = { blockCount, used, bytes };
+}
+
+/**
+ * Copy a string into the pool, the caller holds the lock
+ *
+ * @param value The text to store
+ * @return Reference to the stored copy
+ */
+StringPool::Ref StringPool::append(string_view value) {
+	size_t needed = sizeof(uint32_t) + value.size();
+	if (needed > BLOCK_SIZE) {
+		throw length_error("String too long for StringPool");
+	}
+	if (blockCount == 0 || used + needed > BLOCK_SIZE) { // start a new block, the rest of the old one stays unused
+		if (blockCount == MAX_BLOCKS) {
+			throw length_error("StringPool is full");
+		}
+		blocks[blockCount++].reset(new char[BLOCK_SIZE]);
+		used = 0;
+	}
+
+	Ref ref = static_cast<Ref>(((blockCount - 1) << BLOCK_BITS) | used);
+	char* at = blocks[blockCount - 1].get() + used;
+	uint32_t length = static_cast<uint32_t>(value.size());
+	memcpy(at, &length, sizeof(length));
+	if (!value.empty()) { // an empty view may have no data pointer
+		memcpy(at + sizeof(length), value.data(), value.size());
+	}
+	used += needed;
+	bytes += needed;
+	return ref;
+}
+
+/**
+ * Copy a string into the pool
+ *
+ * @param value The text to store
+ * @return Reference to the stored copy
+ */
+StringPool::Ref StringPool::Add(string_view value) {
+	lock_guard<mutex> lock(writing);
+	return append(value);
+}
+
+/**
+ * Copy a string into the pool once, later calls with the same text share it
+ *
+ * @param value The text to store
+ * @return Reference to the stored copy
+ */
+StringPool::Ref StringPool::Intern(string_view value) {
+	lock_guard<mutex> lock(writing);
+	auto found = interned.find(string(value));
+	if (found != interned.end()) {
+		return found->second;
+	}
+	Ref ref = append(value);
+	interned.emplace(string(value), ref);
+	return ref;
+}
+
+/**
+ * Look up a stored string. Safe while other threads add, as long as the
+ * reference itself was handed over through some synchronization.
+ *
+ * @param ref Reference returned by Add() or Intern()
+ * @return The text, valid for the life of the pool
+ */
+string_view StringPool::Get(Ref ref) const {
+	const char* at = blocks[ref >> BLOCK_BITS].get() + (ref & (BLOCK_SIZE - 1));
+	uint32_t length;
+	memcpy(&length, at, sizeof(length));
+	return string_view(at + sizeof(length), length);
+}
+
+/**
+ * Bytes of text held, length prefixes included
+ */
+size_t StringPool::Bytes() const {
+	lock_guard<mutex> lock(writing);
+	return bytes;
+}
+
+/**
+ * How full the pool is now, for a later Rewind()
+ */
+StringPool::Mark StringPool::Position() const {
+	lock_guard<mutex> lock(writing);
+	return { blockCount, used, bytes };
+}
+
+/**
+ * Drop the strings added after a mark, the caller holds the lock
+ *
+ * @param mark Taken by Position() on this pool, with at least EMPTY in it
+ */
+void StringPool::rewind(Mark mark) {
+	Ref end = static_cast<Ref>(((mark.blockCount - 1) << BLOCK_BITS) | mark.used); // refs only grow
+	for (auto it = interned.begin(); it != interned.end();) {
+		it = it->second >= end ? interned.erase(it) : next(it);
+	}
+	while (blockCount > mark.blockCount) {
+		blocks[--blockCount].reset();
+	}
+	used = mark.used;
+	bytes = mark.bytes;
+}
+
+/**
+ * Drop every string added since a mark, their blocks go back to the
+ * system. Nothing may refer to them anymore and no other thread may be
+ * using the pool.
+ *
+ * @param mark Taken by Position() on this pool
+ */
+void StringPool::Rewind(Mark mark) {
+	lock_guard<mutex> lock(writing);
+	rewind(mark);
+}
+
+/**
+ * Drop every string but EMPTY, for when all the bids are replaced.
+ * Nothing may refer to them anymore and no other thread may be using the pool.
+ */
+void StringPool::Reset() {
+	lock_guard<mutex> lock(writing);
+	rewind(start);
+}
+
+//============================================================================
+// Bid helpers
+//============================================================================
+
+/**
+ * Convert an Auction ID to its numeric form, done once when a bid is read.
+ * Only plain decimal digits are taken. The eBid exports never pad an ID,
+ * so one with a leading zero is rejected rather than merged with the ID
+ * it would parse to ("0098190" is not "98190").
+ *
+ * @param text The Auction ID, surrounding spaces are ignored
+ * @param id Set to the ID when the text is one
+ * @return false if the text is not a positive 32-bit number written without leading zeros
+ */
+bool ParseBidId(string_view text, uint32_t& id) {
+	while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+		text.remove_prefix(1);
+	}
+	while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) {
+		text.remove_suffix(1);
+	}
+	if (text.empty() || text.size() > 10 || text.front() == '0') { // UINT32_MAX has 10 digits
+		return false;
+	}
+
+	uint64_t value = 0;
+	for (char c : text) {
+		if (c < '0' || c > '9') {
+			return false;
+		}
+		value = value * 10 + (c - '0');
+	}
+	if (value > UINT32_MAX) {
+		return false;
+	}
+	id = static_cast<uint32_t>(value);
+	return true;
+}
+
+/**
+ * Convert a dollar amount to whole cents
+ */
+int64_t ToCents(double dollars) {
+	return llround(dollars * 100.0);
+}
+
+/**
+ * Make a bid from a row streamed with BID_COLUMNS, its text goes into bidStrings.
+ * A row whose Auction ID is not one is reported on cerr and left out, it
+ * would otherwise be confused with other bids. An empty or malformed
+ * winning bid counts as $0, as atof gave.
+ *
+ * @param row Title, Auction ID, winning bid and fund, in that order
+ * @param bid Filled in from the row
+ * @return false if the row has no valid Auction ID, bid is left as it was
+ */
+bool BidFromRow(const csv::Row& row, Bid& bid) {
+	uint32_t id;
+	if (!ParseBidId(row.view(1), id)) {
+		cerr << "Skipping row with Auction ID \"" << row.view(1) << "\"" << endl;
+		return false;
+	}
+
+	bid.bidId = id;
+	bid.title = bidStrings.Add(row.view(0));
+	bid.fund = bidStrings.Intern(row.view(3)); // only a handful of funds, stored once each
+	double dollars;
+	if (!csv::parseCurrency(row.view(2), dollars)) {
+		dollars = 0;
+	}
+	bid.amount = ToCents(dollars);
+	return true;
+}
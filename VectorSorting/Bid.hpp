@@ -0,0 +1,110 @@
+//============================================================================
+// Name        : Bid.hpp
+// Author      : Connor Sculthorpe
+// Version     : 1.0
+// Description : Compact bid record shared by every bid container, its text
+//               lives in one string pool
+//============================================================================
+
+#ifndef BID_HPP
+#define BID_HPP
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace csv {
+class Row;
+}
+
+/**
+ * Store for bid text. A string is referred to by a 32-bit reference
+ * instead of owning its own heap allocation.
+ *
+ * Text is kept in fixed blocks that never move, so Get() needs no lock and
+ * may run while another thread adds; adding is serialized by a mutex.
+ * Strings are never freed one by one: Reset() drops them all when the bids
+ * using them are replaced, and Rewind() drops those added since a
+ * Position(), for bids that only live for a while.
+ */
+class StringPool {
+
+public:
+	typedef uint32_t Ref; // block number in the high bits, offset in the block in the low bits
+	static const Ref EMPTY = 0; // always the empty string
+
+	struct Mark { // how full the pool was at some point
+		size_t blockCount;
+		size_t used;
+		size_t bytes;
+	};
+
+private:
+	static constexpr unsigned int BLOCK_BITS = 20; // 1 MiB blocks
+	static constexpr size_t BLOCK_SIZE = size_t(1) << BLOCK_BITS;
+	static constexpr size_t MAX_BLOCKS = size_t(1) << (32 - BLOCK_BITS);
+
+	std::unique_ptr<char[]> blocks[MAX_BLOCKS]; // each string sits behind a 32-bit length, never across blocks
+	size_t blockCount = 0;
+	size_t used = 0; // bytes used in the last block
+	size_t bytes = 0;
+	std::unordered_map<std::string, Ref> interned; // only strings added through Intern()
+	Mark start; // just EMPTY, where Reset() goes back to
+	mutable std::mutex writing;
+
+	Ref append(std::string_view value);
+	void rewind(Mark mark);
+
+public:
+	StringPool();
+	Ref Add(std::string_view value);
+	Ref Intern(std::string_view value); // for values that repeat a lot, like fund
+	std::string_view Get(Ref ref) const;
+	size_t Bytes() const;
+	Mark Position() const;
+	void Rewind(Mark mark); // drop every string added since the mark
+	void Reset(); // drop every string, EMPTY stays
+};
+
+// The one pool every Bid points into, Reset() whenever the loaded bids are replaced
+extern StringPool bidStrings;
+
+// define a structure to hold bid information
+struct Bid {
+	int64_t amount; // in cents
+	uint32_t bidId; // unique identifier, 0 when there is no bid
+	StringPool::Ref title; // in bidStrings
+	StringPool::Ref fund; // in bidStrings
+
+	Bid() {
+		amount = 0;
+		bidId = 0;
+		title = StringPool::EMPTY;
+		fund = StringPool::EMPTY;
+	}
+
+	std::string_view Title() const {
+		return bidStrings.Get(title);
+	}
+
+	std::string_view Fund() const {
+		return bidStrings.Get(fund);
+	}
+
+	double Dollars() const {
+		return amount / 100.0;
+	}
+};
+
+bool ParseBidId(std::string_view text, uint32_t& id); // false when the text isn't an Auction ID
+int64_t ToCents(double dollars);
+
+// The CSV columns BidFromRow() reads, in its order; the Dec 2016 export names them differently
+extern const std::vector<std::string> BID_COLUMNS;
+bool BidFromRow(const csv::Row& row, Bid& bid); // false, and reported, for a row without an Auction ID
+
+#endif // BID_HPP
@@ -10,6 +10,7 @@
 #include <iostream>
 #include <time.h>
 
+#include "Bid.hpp"
 #include "CSVparser.hpp"
 
 using namespace std;
@@ -21,17 +22,6 @@ using namespace std;
 // forward declarations
 double strToDouble(string str, char ch);
 
-// define a structure to hold bid information
-struct Bid {
-    string bidId; // unique identifier
-    string title;
-    string fund;
-    double amount;
-    Bid() {
-        amount = 0.0;
-    }
-};
-
 //============================================================================
 // Static methods used for testing
 //============================================================================
@@ -42,8 +32,8 @@ struct Bid {
  * @param bid struct containing the bid info
  */
 void displayBid(Bid bid) {
-    cout << bid.bidId << ": " << bid.title << " | " << bid.amount << " | "
-            << bid.fund << endl;
+    cout << bid.bidId << ": " << bid.Title() << " | " << bid.Dollars() << " | "
+            << bid.Fund() << endl;
     return;
 }
 
@@ -54,22 +44,29 @@ void displayBid(Bid bid) {
  */
 Bid getBid() {
     Bid bid;
+    string text;
 
     cout << "Enter Id: ";
     cin.ignore();
-    getline(cin, bid.bidId);
+    getline(cin, text);
+    while (!ParseBidId(text, bid.bidId)) {
+        cout << "Not an Auction ID, enter Id: ";
+        getline(cin, text);
+    }
 
     cout << "Enter title: ";
-    getline(cin, bid.title);
+    getline(cin, text);
+    bid.title = bidStrings.Add(text);
 
     cout << "Enter fund: ";
-    cin >> bid.fund;
+    cin >> text;
+    bid.fund = bidStrings.Intern(text);
 
     cout << "Enter amount: ";
     cin.ignore();
     string strAmount;
     getline(cin, strAmount);
-    bid.amount = strToDouble(strAmount, '$');
+    bid.amount = ToCents(strToDouble(strAmount, '$'));
 
     return bid;
 }
@@ -86,19 +83,19 @@ vector<Bid> loadBids(string csvPath) {
     // Define a vector data structure to hold a collection of bids.
     vector<Bid> bids;
 
-    // initialize the CSV Parser using the given path
-    csv::Parser file = csv::Parser(csvPath);
+    // stream the CSV file using the given path, rows are parsed while the file is still being read.
+    // Only the columns a Bid uses are split out.
+    csv::Stream file(csvPath, BID_COLUMNS);
 
     try {
         // loop to read rows of a CSV file
-        for (int i = 0; i < file.rowCount(); i++) {
+        for (csv::Row& row : file) { // one row buffer is reused for every record
 
             // Create a data structure and add to the collection of bids
             Bid bid;
-            bid.bidId = file[i][1];
-            bid.title = file[i][0];
-            bid.fund = file[i][8];
-            bid.amount = strToDouble(file[i][4], '$');
+            if (!BidFromRow(row, bid)) {
+                continue;
+            }
 
             //cout << "Item: " << bid.title << ", Fund: " << bid.fund << ", Amount: " << bid.amount << endl;
 
@@ -126,18 +123,18 @@ int partition(vector<Bid>& bids, int begin, int end) {
     int highIndex = end;
     // pick the middle element as pivot point
     int midpoint = lowIndex + (highIndex - lowIndex) / 2;
-    string pivot = bids[midpoint].title;
+    string_view pivot = bids[midpoint].Title(); // pool text never moves, so the view stays valid
 
     bool done = false;
 
     // while not done 
     while (!done) {
         // keep incrementing low index while bids[low] < bids[pivot]
-        while (bids[lowIndex].title < pivot) {
+        while (bids[lowIndex].Title() < pivot) {
             ++lowIndex;
         }
         // keep decrementing high index while bids[pivot] < bids[high]
-        while (pivot < bids[highIndex].title) {
+        while (pivot < bids[highIndex].Title()) {
             --highIndex;
         }
         /* If there are zero or one elements remaining,
@@ -201,7 +198,7 @@ void selectionSort(vector<Bid>& bids) {
     for (int pos = 0; pos < size - 1; ++pos) { 
         min = pos;
         for (int i = pos + 1; i < size; ++i) { // loop over remaining elements to the right of position
-            if (bids[i].title < bids[min].title) { // if this element's title is less than minimum title
+            if (bids[i].Title() < bids[min].Title()) { // if this element's title is less than minimum title
                 min = i; // this element becomes the minimum
                 //cout << "innermost loop\n"; // Test cout to visualize the speed, greatly slows down program.
             }
@@ -269,6 +266,10 @@ int main(int argc, char* argv[]) {
             // Initialize a timer variable before loading bids
             ticks = clock();
 
+            // A reload replaces the bids, and their text with them
+            bids.clear();
+            bidStrings.Reset();
+
             // Complete the method call to load the bids
             bids = loadBids(csvPath);
 